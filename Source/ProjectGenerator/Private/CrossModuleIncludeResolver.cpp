@@ -0,0 +1,296 @@
+#include "CrossModuleIncludeResolver.h"
+#include "ProjectGeneratorCommandlet.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "UObject/MetaData.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/UObjectIterator.h"
+
+//Runs the function on the game thread, waiting for it to complete when called from any other thread
+static void ExecuteOnGameThread(TFunctionRef<void()> Function) {
+	if (IsInGameThread()) {
+		Function();
+		return;
+	}
+	FGraphEventRef GameThreadTask = FFunctionGraphTask::CreateAndDispatchWhenReady([&]() {
+		Function();
+	}, TStatId(), NULL, ENamedThreads::GameThread);
+
+	FTaskGraphInterface::Get().WaitUntilTaskCompletes(GameThreadTask);
+}
+
+FCrossModuleIncludeResolver::FCrossModuleIncludeResolver(const TSet<FString>& InEngineModules) : EngineModules(InEngineModules) {
+}
+
+bool FCrossModuleIncludeResolver::ResolveInclude(const FString& HeaderFileName, const FCrossModuleIncludeKey& CacheKey, FString& OutIncludeString) {
+	//Same objects are referenced by thousands of headers, so most of the lookups never need to leave the calling thread
+	bool bResolvedInclude = false;
+	if (FindCachedInclude(CacheKey, OutIncludeString, bResolvedInclude)) {
+		return bResolvedInclude;
+	}
+	
+	//Module loading and package lookups are only safe on the game thread, so we dispatch the lookup there and wait for it
+	//Game thread tasks are executed one after another, which also serializes all of the lookups made by the workers
+	ExecuteOnGameThread([&]() {
+		bResolvedInclude = ResolveAndCacheIncludeOnGameThread(HeaderFileName, CacheKey, OutIncludeString);
+	});
+	return bResolvedInclude;
+}
+
+void FCrossModuleIncludeResolver::PrepareIncludes(const TMap<FCrossModuleIncludeKey, FString>& ReferencedObjects, const TSet<FString>& ReferencedModules) {
+	PreloadEngineModules(ReferencedModules);
+	PreResolveIncludes(ReferencedObjects);
+}
+
+void FCrossModuleIncludeResolver::PreloadEngineModules(const TSet<FString>& ModuleNames) {
+	//Sorted so the modules are always loaded in the same order, regardless of the order headers have been scanned in
+	TArray<FString> SortedModuleNames = ModuleNames.Array();
+	SortedModuleNames.Sort();
+
+	ExecuteOnGameThread([&]() {
+		FModuleManager& ModuleManager = FModuleManager::Get();
+		const double LoadStartTime = FPlatformTime::Seconds();
+		int32 ModulesLoaded = 0;
+
+		for (const FString& ModuleName : SortedModuleNames) {
+			if (!EngineModules.Contains(ModuleName) || ModuleManager.IsModuleLoaded(*ModuleName) || ModulesThatHaveTriedBeingLoaded.Contains(ModuleName)) {
+				continue;
+			}
+			ModulesThatHaveTriedBeingLoaded.Add(ModuleName);
+
+			if (ModuleManager.LoadModule(*ModuleName) != NULL) {
+				UE_LOG(LogProjectGeneratorCommandlet, Display, TEXT("Force loaded engine module %s"), *ModuleName);
+				ModulesLoaded++;
+			} else {
+				UE_LOG(LogProjectGeneratorCommandlet, Warning, TEXT("Failed to load engine module %s referenced by the header files"), *ModuleName);
+			}
+		}
+
+		//Objects of all of the modules loaded above are registered in a single pass
+		if (ModulesLoaded) {
+			ProcessNewlyLoadedUObjects();
+		}
+		ModulesForceLoaded += ModulesLoaded;
+		ModuleLoadingSeconds += FPlatformTime::Seconds() - LoadStartTime;
+
+		UE_LOG(LogProjectGeneratorCommandlet, Display, TEXT("Preloaded %d engine modules in %.2f seconds"), ModulesLoaded, FPlatformTime::Seconds() - LoadStartTime);
+	});
+}
+
+void FCrossModuleIncludeResolver::PreResolveIncludes(const TMap<FCrossModuleIncludeKey, FString>& ReferencedObjects) {
+	ExecuteOnGameThread([&]() {
+		for (const TPair<FCrossModuleIncludeKey, FString>& ReferencedObject : ReferencedObjects) {
+			FString ResolvedIncludeString;
+			ResolveAndCacheIncludeOnGameThread(ReferencedObject.Value, ReferencedObject.Key, ResolvedIncludeString);
+		}
+	});
+}
+
+void FCrossModuleIncludeResolver::LogCacheStatistics() const {
+	int32 UnresolvedIncludes = 0;
+	{
+		FReadScopeLock ReadLock(ResolvedIncludeCacheLock);
+		for (const TPair<FCrossModuleIncludeKey, FString>& CacheEntry : ResolvedIncludeCache) {
+			if (CacheEntry.Value.IsEmpty()) {
+				UnresolvedIncludes++;
+			}
+		}
+	}
+	UE_LOG(LogProjectGeneratorCommandlet, Display, TEXT("Cross module include cache: %d hits, %d misses (%d objects could not be resolved)"), CacheHits.GetValue(), CacheMisses.GetValue(), UnresolvedIncludes);
+}
+
+bool FCrossModuleIncludeResolver::FindCachedInclude(const FCrossModuleIncludeKey& CacheKey, FString& OutIncludeString, bool& bOutResolved) {
+	FReadScopeLock ReadLock(ResolvedIncludeCacheLock);
+	
+	if (const FString* CachedIncludeString = ResolvedIncludeCache.Find(CacheKey)) {
+		CacheHits.Increment();
+		bOutResolved = !CachedIncludeString->IsEmpty();
+		if (bOutResolved) {
+			OutIncludeString = *CachedIncludeString;
+		}
+		return true;
+	}
+	return false;
+}
+
+bool FCrossModuleIncludeResolver::ResolveAndCacheIncludeOnGameThread(const FString& HeaderFileName, const FCrossModuleIncludeKey& CacheKey, FString& OutIncludeString) {
+	//Another worker might have requested the same object while this request was waiting in the queue
+	bool bResolvedInclude = false;
+	if (FindCachedInclude(CacheKey, OutIncludeString, bResolvedInclude)) {
+		return bResolvedInclude;
+	}
+	CacheMisses.Increment();
+
+	FString ResolvedIncludeString;
+	bResolvedInclude = ResolveIncludeOnGameThread(HeaderFileName, CacheKey.ModuleName, CacheKey.ObjectName, CacheKey.FallbackName, ResolvedIncludeString);
+
+	FWriteScopeLock WriteLock(ResolvedIncludeCacheLock);
+	ResolvedIncludeCache.Add(CacheKey, bResolvedInclude ? ResolvedIncludeString : FString());
+
+	if (bResolvedInclude) {
+		OutIncludeString = MoveTemp(ResolvedIncludeString);
+	}
+	return bResolvedInclude;
+}
+
+bool FCrossModuleIncludeResolver::ResolveIncludeOnGameThread(const FString& HeaderFileName, const FString& ModuleName, const FString& ObjectName, const FString& FallbackName, FString& OutIncludeString) {
+	check(IsInGameThread());
+	FModuleManager& ModuleManager = FModuleManager::Get();
+
+	//Try loading the module if it has not been loaded already and we know for a fact that it exists inside of the engine
+	//TODO this is surely a hack, we need a better solution involving using uproject file data
+	if (EngineModules.Contains(ModuleName) && !ModuleManager.IsModuleLoaded(*ModuleName)) {
+		if (!ModulesThatHaveTriedBeingLoaded.Contains(ModuleName)) {
+			ModulesThatHaveTriedBeingLoaded.Add(ModuleName);
+
+			const double LoadStartTime = FPlatformTime::Seconds();
+			IModuleInterface* LoadedModule = ModuleManager.LoadModule(*ModuleName);
+			if (LoadedModule != NULL) {
+				ProcessNewlyLoadedUObjects();
+				ModulesForceLoaded++;
+				UE_LOG(LogProjectGeneratorCommandlet, Warning, TEXT("Force loaded engine module %s"), *ModuleName);
+			} else {
+				UE_LOG(LogProjectGeneratorCommandlet, Warning, TEXT("Failed to load engine module %s required by the header file %s"), *ModuleName, *HeaderFileName);
+			}
+			ModuleLoadingSeconds += FPlatformTime::Seconds() - LoadStartTime;
+		}
+	}
+
+	const FString ModulePackageName = FString::Printf(TEXT("/Script/%s"), *ModuleName);
+	UPackage* ModulePackage = FindPackage(NULL, *ModulePackageName);
+
+	//If module package is not found, we assume it's one of the game modules, and generate a normal include
+	if (ModulePackage == NULL) {
+		OutIncludeString = FString::Printf(TEXT("#include \"%s.h\""), *FallbackName);
+		return true;
+	}
+
+	//Module has been found, attempt to resolve the object reference now
+	UObject* FoundModuleObject = FindObjectFast<UObject>(ModulePackage, *ObjectName);
+
+	//Print a warning if we couldn't find an object but module is there
+	if (FoundModuleObject == NULL) {
+		UE_LOG(LogProjectGeneratorCommandlet, Warning, TEXT("Couldn't find native object %s inside of the module %s package"), *ObjectName, *ModuleName);
+		return false;
+	}
+
+	FString ObjectIncludePath;
+	if (!GetSpecialObjectIncludePath(FoundModuleObject, ObjectIncludePath)) {
+		ObjectIncludePath = GetIncludePathForObject(FoundModuleObject);
+	}
+	if (ObjectIncludePath.IsEmpty()) {
+		return false;
+	}
+	OutIncludeString = FString::Printf(TEXT("#include \"%s\""), *ObjectIncludePath);
+	return true;
+}
+
+void FCrossModuleIncludeResolver::CollectLoadedObjectIncludePaths(TMap<FString, TMap<FString, FString>>& OutModuleObjectIncludePaths) {
+	check(IsInGameThread());
+	static const TCHAR ScriptPackagePrefix[] = TEXT("/Script/");
+
+	for (TObjectIterator<UPackage> PackageIt; PackageIt; ++PackageIt) {
+		UPackage* ModulePackage = *PackageIt;
+		const FString PackageName = ModulePackage->GetName();
+		if (!PackageName.StartsWith(ScriptPackagePrefix)) {
+			continue;
+		}
+
+		//Module package is recorded even if it has no types, so the references into it are not mistaken for the game module ones
+		TMap<FString, FString>& ObjectIncludePaths = OutModuleObjectIncludePaths.FindOrAdd(PackageName.Mid(UE_ARRAY_COUNT(ScriptPackagePrefix) - 1));
+		UMetaData* MetaData = ModulePackage->GetMetaData();
+
+		//Only the top level types can be referenced by the markers, which skips class default objects and nested functions
+		ForEachObjectWithOuter(ModulePackage, [&](UObject* Object) {
+			if (!Object->IsA<UField>()) {
+				return;
+			}
+			FString ObjectIncludePath;
+			if (!GetSpecialObjectIncludePath(Object, ObjectIncludePath)) {
+				//Types without the metadata cannot be resolved by the live lookup either, so they are recorded as unresolved
+				if (MetaData == NULL || !MetaData->HasValue(Object, TEXT("ModuleRelativePath"))) {
+					ObjectIncludePaths.Add(Object->GetName(), FString());
+					return;
+				}
+				ObjectIncludePath = GetIncludePathForObject(Object);
+			}
+			ObjectIncludePaths.Add(Object->GetName(), ObjectIncludePath);
+		}, false);
+	}
+}
+
+FString FCrossModuleIncludeResolver::GetIncludePathForObject(UObject* Object) {
+	//We cannot use "IncludePath" metadata attribute here because it's not added for UScriptStruct,
+	//and object we have as argument can be either UClass or UScriptStruct, or maybe even UEnum if we decide to
+	//support them at some point. However, "ModuleRelativePath" is present on all of these objects,
+	//and even on function and property objects. According to UHT source, only difference
+	//between these two is that include path has Public/Private/Classes prefixes stripped. We can
+	//mimic that behavior and get uniform include paths for all defined objects
+
+	UPackage* Package = Object->GetOutermost();
+	UMetaData* MetaData = Package->GetMetaData();
+	checkf(MetaData, TEXT("Metadata object is not found on the package %s"), *Package->GetName());
+
+	FString IncludePath = MetaData->GetValue(Object, TEXT("ModuleRelativePath"));
+	checkf(!IncludePath.IsEmpty(), TEXT("ModuleRelativePath metadata not found on object %s"), *Object->GetPathName());
+
+	// Walk over the first potential slash
+	if (IncludePath.StartsWith(TEXT("/"))) {
+		IncludePath.RemoveAt(0);
+	}
+	// Does this module path start with a known include path location? If so, we can cut that part out of the include path
+	static const TCHAR PublicFolderName[]  = TEXT("Public/");
+	static const TCHAR PrivateFolderName[] = TEXT("Private/");
+	static const TCHAR ClassesFolderName[] = TEXT("Classes/");
+	if (IncludePath.StartsWith(PublicFolderName)) {
+		IncludePath.RemoveAt(0, UE_ARRAY_COUNT(PublicFolderName) - 1);
+	}
+	if (IncludePath.StartsWith(PrivateFolderName)) {
+		IncludePath.RemoveAt(0, UE_ARRAY_COUNT(PrivateFolderName) - 1);
+	}
+	if (IncludePath.StartsWith(ClassesFolderName)) {
+		IncludePath.RemoveAt(0, UE_ARRAY_COUNT(ClassesFolderName) - 1);
+	}
+	return IncludePath;
+}
+
+const TMap<UObject*, FString>& GetSpecialObjectIncludePaths() {
+	static TMap<UObject*, FString> ResultMap;
+
+	if (!ResultMap.Num()) {
+		ResultMap.Add(UObject::StaticClass(), TEXT("UObject/Object.h"));
+
+		ResultMap.Add(UClass::StaticClass(), TEXT("UObject/Class.h"));
+		ResultMap.Add(UScriptStruct::StaticClass(), TEXT("UObject/Class.h"));
+		ResultMap.Add(UEnum::StaticClass(), TEXT("UObject/Class.h"));
+		ResultMap.Add(UInterface::StaticClass(), TEXT("UObject/Interface.h"));
+	}
+	return ResultMap;
+}
+
+//Handles some special paths inside of the CoreUObject specifically
+bool FCrossModuleIncludeResolver::GetSpecialObjectIncludePath(UObject* Object, FString& OutIncludePath) {
+	const TMap<UObject*, FString>& BaseObjectMap = GetSpecialObjectIncludePaths();
+
+	//Check the base object map for basic CoreUObject type definitions
+	if (BaseObjectMap.Contains(Object)) {
+		OutIncludePath = BaseObjectMap.FindChecked(Object);
+		return true;
+	}
+
+	//Check if the object is class has NoExport flag, and then include the NoExportTypes.h
+	if (const UClass* Class = Cast<UClass>(Object)) {
+		if (Class->HasAnyClassFlags(CLASS_NoExport)) {
+			OutIncludePath = TEXT("UObject/NoExportTypes.h");
+			return true;
+		}
+	}
+	if (const UScriptStruct* Struct = Cast<UScriptStruct>(Object)) {
+		if ((Struct->StructFlags & STRUCT_NoExport) != 0) {
+			OutIncludePath = TEXT("UObject/NoExportTypes.h");
+			return true;
+		}
+	}
+
+	//Otherwise, assume it is a normal object that has the correct include path
+	return false;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ICrossModuleIncludeResolver.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/ScopeRWLock.h"
+
+/**
+ * Resolves objects referenced by the CROSS-MODULE INCLUDE markers using the live UObject registry of the editor
+ * Engine modules are either preloaded in bulk or loaded on demand, and all of the object lookups happen on the game thread,
+ * so the resolver can be safely used from the worker threads processing the header files
+ * Results are memoized per referenced object, including the ones that could not be resolved
+ */
+class FCrossModuleIncludeResolver : public ICrossModuleIncludeResolver {
+public:
+	explicit FCrossModuleIncludeResolver(const TSet<FString>& InEngineModules);
+
+	virtual bool ResolveInclude(const FString& HeaderFileName, const FCrossModuleIncludeKey& IncludeKey, FString& OutIncludeString) override;
+
+	/** Preloads all of the referenced engine modules and resolves the references into the cache */
+	virtual void PrepareIncludes(const TMap<FCrossModuleIncludeKey, FString>& ReferencedObjects, const TSet<FString>& ReferencedModules) override;
+
+	/**
+	 * Loads all of the given engine modules which are not loaded yet, and registers their objects at once afterwards
+	 * Much cheaper than loading them one by one on demand, because every object registration pass walks all of the pending objects
+	 */
+	void PreloadEngineModules(const TSet<FString>& ModuleNames);
+
+	/** Resolves all of the given object references into the cache, mapped to the header file referencing them for the warnings */
+	void PreResolveIncludes(const TMap<FCrossModuleIncludeKey, FString>& ReferencedObjects);
+
+	virtual void LogCacheStatistics() const override;
+
+	virtual int32 GetCacheHits() const override { return CacheHits.GetValue(); }
+	virtual int32 GetCacheMisses() const override { return CacheMisses.GetValue(); }
+	virtual int32 GetModulesForceLoaded() const override { return ModulesForceLoaded; }
+	virtual double GetModuleLoadingSeconds() const override { return ModuleLoadingSeconds; }
+
+	/** Collects include paths of all of the native types inside of the script packages loaded right now, keyed by the module and the object name */
+	static void CollectLoadedObjectIncludePaths(TMap<FString, TMap<FString, FString>>& OutModuleObjectIncludePaths);
+
+	static FString GetIncludePathForObject(UObject* Object);
+	static bool GetSpecialObjectIncludePath(UObject* Object, FString& OutIncludePath);
+private:
+	bool FindCachedInclude(const FCrossModuleIncludeKey& CacheKey, FString& OutIncludeString, bool& bOutResolved);
+	bool ResolveAndCacheIncludeOnGameThread(const FString& HeaderFileName, const FCrossModuleIncludeKey& CacheKey, FString& OutIncludeString);
+	bool ResolveIncludeOnGameThread(const FString& HeaderFileName, const FString& ModuleName, const FString& ObjectName, const FString& FallbackName, FString& OutIncludeString);
+
+	const TSet<FString>& EngineModules;
+	TSet<FString> ModulesThatHaveTriedBeingLoaded;
+	int32 ModulesForceLoaded = 0;
+	double ModuleLoadingSeconds = 0.0;
+
+	/** Resolved include strings, empty string means the object could not be resolved. Only written on the game thread */
+	TMap<FCrossModuleIncludeKey, FString> ResolvedIncludeCache;
+	mutable FRWLock ResolvedIncludeCacheLock;
+	FThreadSafeCounter CacheHits;
+	FThreadSafeCounter CacheMisses;
+};
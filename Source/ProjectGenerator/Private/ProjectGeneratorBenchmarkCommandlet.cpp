@@ -0,0 +1,18 @@
+#include "ProjectGeneratorBenchmarkCommandlet.h"
+#include "ProjectGeneratorCommandlet.h"
+#include "ProjectGeneratorBenchmark.h"
+#include "ProjectGeneratorSession.h"
+
+UProjectGeneratorBenchmarkCommandlet::UProjectGeneratorBenchmarkCommandlet() {
+	this->HelpDescription = TEXT("Measures the project generator on the synthetic header dump of the configurable size");
+	this->HelpUsage = FString(TEXT("ProjectGeneratorBenchmark ")) + FProjectGeneratorBenchmark::Usage + TEXT(" [-Threads=<NumThreads>] [-IOWorkers=<NumIOWorkers>] [-LinkMode=hardlink|reflink|copy] [-Incremental] [-IncludeDatabase=<IncludeDatabaseFile>]");
+}
+
+int32 UProjectGeneratorBenchmarkCommandlet::Main(const FString& Params) {
+	//Same session as the normal generation, so the live resolver and the include database can be compared against each other
+	FProjectGeneratorSession Session;
+	if (!UProjectGeneratorCommandlet::InitializeSession(Params, Session)) {
+		return 1;
+	}
+	return FProjectGeneratorBenchmark::Run(Params, Session);
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ProjectGeneratorBenchmarkCommandlet.generated.h"
+
+UCLASS()
+class PROJECTGENERATOR_API UProjectGeneratorBenchmarkCommandlet : public UCommandlet {
+	GENERATED_BODY()
+public:
+	UProjectGeneratorBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
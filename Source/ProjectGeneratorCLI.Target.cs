@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class ProjectGeneratorCLITarget : TargetRules
+{
+	public ProjectGeneratorCLITarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		LaunchModuleName = "ProjectGeneratorCLI";
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+
+		//Standalone program does not need any of the engine, only the core library
+		bBuildDeveloperTools = false;
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = false;
+		bCompileICU = false;
+		bUseMallocProfiler = false;
+		bIsBuildingConsoleApplication = true;
+	}
+}
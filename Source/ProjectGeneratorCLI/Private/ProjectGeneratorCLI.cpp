@@ -0,0 +1,70 @@
+#include "RequiredProgramMainCPPInclude.h"
+#include "ProjectGenerator.h"
+#include "ProjectGeneratorSession.h"
+#include "IncludeDatabase.h"
+#include "ProjectGeneratorBenchmark.h"
+
+IMPLEMENT_APPLICATION(ProjectGeneratorCLI, "ProjectGeneratorCLI");
+
+static const TCHAR* ProjectGeneratorCLIUsage = TEXT("ProjectGeneratorCLI -IncludeDatabase=<IncludeDatabaseFile> -HeaderRoot=<HeaderRoot> -ProjectFile=<ProjectFile> -PluginManifest=<PluginManifest> -OutputDir=<OutputProjectDir> [-Threads=<NumThreads>] [-IOWorkers=<NumIOWorkers>] [-MemoryLimitMB=<Megabytes>] [-Incremental] [-RefreshEngineCache] [-StatsFile=<StatsFile>] [-DryRun] [-PlanFile=<PlanFile>] [-LinkMode=hardlink|reflink|copy] [-Watch] [-GeneratePCH] [-PruneBuildDependencies] [-DependencyGraph=<GraphFile>] [-ForwardDeclare] [-SplitHeaders] [-ValidateSyntax] [-SyntaxCompiler=<Compiler>] [-SyntaxCompilerArgs=<Arguments>] [-Modules=<ModuleList>] | ProjectGeneratorCLI -IncludeDatabase=<IncludeDatabaseFile> -BatchFile=<BatchFile> [-BatchConcurrency=<NumJobs>] | ProjectGeneratorCLI -IncludeDatabase=<IncludeDatabaseFile> -Benchmark [<BenchmarkArguments>]");
+
+static int32 RunProjectGenerator(const FString& Params) {
+	//There is no UObject registry in the standalone program, so the includes can only be resolved using the exported include database
+	FString IncludeDatabaseFilePath;
+	if (!FParse::Value(*Params, TEXT("IncludeDatabase="), IncludeDatabaseFilePath)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Missing include database. Export it using the ProjectGenerator commandlet with -ExportIncludeDatabase=<IncludeDatabaseFile>. Usage: %s"), ProjectGeneratorCLIUsage);
+		return 1;
+	}
+
+	TArray<FCommandletRunParams> BatchJobs;
+	FString BatchFilePath;
+	const bool bRunBenchmark = FParse::Param(*Params, TEXT("Benchmark"));
+	
+	if (bRunBenchmark) {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Running benchmark. Usage: %s"), FProjectGeneratorBenchmark::Usage);
+	} else if (FParse::Value(*Params, TEXT("BatchFile="), BatchFilePath)) {
+		if (!FProjectGenerator::ParseBatchFile(Params, BatchFilePath, ProjectGeneratorCLIUsage, BatchJobs)) {
+			return 1;
+		}
+	} else {
+		FCommandletRunParams& ResultParams = BatchJobs.AddDefaulted_GetRef();
+		if (!FProjectGenerator::ParseRunParams(Params, ProjectGeneratorCLIUsage, ResultParams)) {
+			return 1;
+		}
+	}
+
+	TUniquePtr<FIncludeDatabaseResolver> IncludeDatabaseResolver = MakeUnique<FIncludeDatabaseResolver>();
+	if (!IncludeDatabaseResolver->Load(IncludeDatabaseFilePath)) {
+		return 1;
+	}
+	
+	FProjectGeneratorSession Session;
+	FProjectGenerator::InitializeSession(FParse::Param(*Params, TEXT("RefreshEngineCache")), Session);
+	Session.IncludeResolver = MoveTemp(IncludeDatabaseResolver);
+
+	if (bRunBenchmark) {
+		return FProjectGeneratorBenchmark::Run(Params, Session);
+	}
+	if (BatchFilePath.IsEmpty()) {
+		if (FParse::Param(*Params, TEXT("Watch"))) {
+			return FProjectGenerator::Watch(BatchJobs[0], ProjectGeneratorCLIUsage, Session);
+		}
+		return FProjectGenerator::Generate(BatchJobs[0], Session);
+	}
+	
+	int32 BatchConcurrency = 1;
+	FParse::Value(*Params, TEXT("BatchConcurrency="), BatchConcurrency);
+	return FProjectGenerator::RunBatch(BatchJobs, BatchConcurrency, Session);
+}
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV() {
+	const FString CommandLine = FCommandLine::BuildFromArgV(NULL, ArgC, ArgV, NULL);
+	GEngineLoop.PreInit(*CommandLine);
+
+	const int32 ExitCode = RunProjectGenerator(CommandLine);
+
+	FEngineLoop::AppPreExit();
+	FModuleManager::Get().UnloadModulesAtShutdown();
+	FEngineLoop::AppExit();
+	return ExitCode;
+}
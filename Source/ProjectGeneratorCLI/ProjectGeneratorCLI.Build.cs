@@ -0,0 +1,16 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class ProjectGeneratorCLI : ModuleRules
+{
+	public ProjectGeneratorCLI(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+		bLegacyPublicIncludePaths = false;
+		ShadowVariableWarningLevel = WarningLevel.Warning;
+		
+		PrivateIncludePathModuleNames.Add("Launch");
+		PrivateDependencyModuleNames.AddRange(new string[] { "Core", "Projects", "ProjectGeneratorCore" });
+	}
+}
@@ -0,0 +1,160 @@
+#include "EngineDiscoveryCache.h"
+#include "ProjectGenerator.h"
+#include "GeneratedFileManifest.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+static const int32 EngineSnapshotVersion = 1;
+
+//Engine discovery does not descend further than this into the directory tree when computing the fingerprint
+static const int32 EngineFingerprintDirectoryDepth = 2;
+
+static FString GetFullEngineDirectory() {
+	return FPaths::ConvertRelativePathToFull(FPaths::EngineDir());
+}
+
+FString FEngineDiscoveryCache::GetSnapshotFilePath() {
+	//Different engine installations get separate snapshot files, so switching between them does not invalidate the cache
+	const FTCHARToUTF8 EngineDirectoryUTF8(*GetFullEngineDirectory());
+	const FString EngineDirectoryHash = FGeneratedFileManifest::HashBytes((const uint8*) EngineDirectoryUTF8.Get(), EngineDirectoryUTF8.Length());
+
+	return FPaths::ProjectSavedDir() / TEXT("ProjectGenerator") / FString::Printf(TEXT("EngineDiscovery-%s.json"), *EngineDirectoryHash.Left(16));
+}
+
+FString FEngineDiscoveryCache::ComputeEngineFingerprint() {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TArray<FString> FingerprintEntries;
+
+	FingerprintEntries.Add(GetFullEngineDirectory());
+	FingerprintEntries.Add(FEngineVersion::Current().ToString());
+
+	//Adding or removing a plugin or a module changes the modification time of the directory containing it
+	//Only the directories down to the fixed depth are covered, along with the source directories of the plugins found there and the directories inside of them,
+	//so the plugins and modules nested any deeper need -RefreshEngineCache to be picked up
+	auto AddChildDirectoryTimestamps = [&](const FString& Directory, TArray<FString>& OutSubDirectories) {
+		PlatformFile.IterateDirectoryStat(*Directory, [&](const TCHAR* Filename, const FFileStatData& StatData) {
+			if (StatData.bIsDirectory) {
+				FingerprintEntries.Add(FString::Printf(TEXT("%s=%s"), Filename, *StatData.ModificationTime.ToString()));
+				OutSubDirectories.Add(Filename);
+			}
+			return true;
+		});
+	};
+
+	//Modules of the plugin live inside of its source directory, which is deeper than the walk goes for the plugins inside of the category directories
+	auto AddPluginSourceTimestamps = [&](const FString& Directory) {
+		const FString PluginSourceDirectory = Directory / TEXT("Source");
+		if (PlatformFile.DirectoryExists(*PluginSourceDirectory)) {
+			TArray<FString> ModuleDirectories;
+			FingerprintEntries.Add(FString::Printf(TEXT("%s=%s"), *PluginSourceDirectory, *PlatformFile.GetTimeStamp(*PluginSourceDirectory).ToString()));
+			AddChildDirectoryTimestamps(PluginSourceDirectory, ModuleDirectories);
+		}
+	};
+
+	TFunction<void(const FString&, int32)> AddDirectoryTimestamps = [&](const FString& Directory, int32 Depth) {
+		TArray<FString> SubDirectories;
+		AddChildDirectoryTimestamps(Directory, SubDirectories);
+
+		for (const FString& SubDirectory : SubDirectories) {
+			if (Depth < EngineFingerprintDirectoryDepth) {
+				AddDirectoryTimestamps(SubDirectory, Depth + 1);
+			} else {
+				AddPluginSourceTimestamps(SubDirectory);
+			}
+		}
+	};
+
+	for (const FString& RootDirectory : {FPaths::EnginePluginsDir(), FPaths::EngineSourceDir()}) {
+		FingerprintEntries.Add(FString::Printf(TEXT("%s=%s"), *RootDirectory, *PlatformFile.GetTimeStamp(*RootDirectory).ToString()));
+		AddDirectoryTimestamps(RootDirectory, 1);
+	}
+
+	//Directory iteration order is not guaranteed, so the entries are sorted to keep the fingerprint stable
+	FingerprintEntries.Sort();
+	return FGeneratedFileManifest::HashStrings(FingerprintEntries);
+}
+
+bool FEngineDiscoveryCache::LoadSnapshot(const FString& SnapshotFilePath, const FString& EngineFingerprint, FEngineDiscoverySnapshot& OutSnapshot) {
+	FString SnapshotFileContents;
+	if (!FFileHelper::LoadFileToString(SnapshotFileContents, *SnapshotFilePath)) {
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> SnapshotObject;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(SnapshotFileContents), SnapshotObject) || !SnapshotObject.IsValid()) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Failed to parse engine discovery snapshot %s"), *SnapshotFilePath);
+		return false;
+	}
+
+	int32 SnapshotVersion = 0;
+	FString SnapshotFingerprint;
+	if (!SnapshotObject->TryGetNumberField(TEXT("Version"), SnapshotVersion) || SnapshotVersion != EngineSnapshotVersion ||
+		!SnapshotObject->TryGetStringField(TEXT("Fingerprint"), SnapshotFingerprint) || SnapshotFingerprint != EngineFingerprint) {
+		return false;
+	}
+
+	const TSharedPtr<FJsonObject>* PluginsObject;
+	const TArray<TSharedPtr<FJsonValue>>* ModulesArray;
+	if (!SnapshotObject->TryGetObjectField(TEXT("Plugins"), PluginsObject) || !SnapshotObject->TryGetArrayField(TEXT("Modules"), ModulesArray)) {
+		return false;
+	}
+
+	OutSnapshot.EnginePlugins.Empty();
+	OutSnapshot.EngineModules.Empty();
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& PluginEntry : (*PluginsObject)->Values) {
+		TSet<FString>& PluginModules = OutSnapshot.EnginePlugins.Add(PluginEntry.Key);
+
+		for (const TSharedPtr<FJsonValue>& ModuleValue : PluginEntry.Value->AsArray()) {
+			PluginModules.Add(ModuleValue->AsString());
+		}
+	}
+	for (const TSharedPtr<FJsonValue>& ModuleValue : *ModulesArray) {
+		OutSnapshot.EngineModules.Add(ModuleValue->AsString());
+	}
+	return true;
+}
+
+static TArray<TSharedPtr<FJsonValue>> MakeSortedStringArray(const TSet<FString>& Strings) {
+	TArray<FString> SortedStrings = Strings.Array();
+	SortedStrings.Sort();
+
+	TArray<TSharedPtr<FJsonValue>> ResultArray;
+	for (const FString& String : SortedStrings) {
+		ResultArray.Add(MakeShareable(new FJsonValueString(String)));
+	}
+	return ResultArray;
+}
+
+bool FEngineDiscoveryCache::SaveSnapshot(const FString& SnapshotFilePath, const FString& EngineFingerprint, const FEngineDiscoverySnapshot& Snapshot) {
+	TArray<FString> PluginNames;
+	Snapshot.EnginePlugins.GetKeys(PluginNames);
+	PluginNames.Sort();
+
+	const TSharedRef<FJsonObject> PluginsObject = MakeShareable(new FJsonObject());
+	for (const FString& PluginName : PluginNames) {
+		PluginsObject->SetArrayField(PluginName, MakeSortedStringArray(Snapshot.EnginePlugins.FindChecked(PluginName)));
+	}
+
+	const TSharedRef<FJsonObject> SnapshotObject = MakeShareable(new FJsonObject());
+	SnapshotObject->SetNumberField(TEXT("Version"), EngineSnapshotVersion);
+	SnapshotObject->SetStringField(TEXT("EngineDir"), GetFullEngineDirectory());
+	SnapshotObject->SetStringField(TEXT("EngineVersion"), FEngineVersion::Current().ToString());
+	SnapshotObject->SetStringField(TEXT("Fingerprint"), EngineFingerprint);
+	SnapshotObject->SetObjectField(TEXT("Plugins"), PluginsObject);
+	SnapshotObject->SetArrayField(TEXT("Modules"), MakeSortedStringArray(Snapshot.EngineModules));
+
+	FString SnapshotFileContents;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&SnapshotFileContents);
+	if (!FJsonSerializer::Serialize(SnapshotObject, JsonWriter)) {
+		return false;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(SnapshotFilePath));
+	return FFileHelper::SaveStringToFile(SnapshotFileContents, *SnapshotFilePath);
+}
@@ -0,0 +1,102 @@
+#include "GeneratedFileLinker.h"
+#include "HAL/PlatformFilemanager.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_LINUX
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#elif PLATFORM_MAC
+#include <unistd.h>
+#include <sys/clonefile.h>
+#endif
+
+FGeneratedFileLinker::FGeneratedFileLinker(EGeneratedFileLinkMode InLinkMode) : LinkMode(InLinkMode) {
+}
+
+bool FGeneratedFileLinker::LinkOrCopyFile(const FString& TargetFilename, const FString& SourceFilename, bool& bOutLinked) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	bOutLinked = false;
+
+	if (LinkMode != EGeneratedFileLinkMode::Copy && !bFallbackToCopy) {
+		if (CreatePlatformLink(LinkMode, TargetFilename, SourceFilename)) {
+			bOutLinked = true;
+			return true;
+		}
+		
+		//Header dump and the output directory are the same for all of the files, so if one of them cannot be linked none of them can
+		if (!bFallbackToCopy.AtomicSet(true)) {
+			UE_LOG(LogProjectGenerator, Warning, TEXT("Cannot create %s for %s, falling back to copying the files"), LexToString(LinkMode), *TargetFilename);
+		}
+	}
+	return PlatformFile.CopyFile(*TargetFilename, *SourceFilename);
+}
+
+bool FGeneratedFileLinker::CreatePlatformLink(EGeneratedFileLinkMode LinkMode, const FString& TargetFilename, const FString& SourceFilename) {
+	const FString FullTargetFilename = FPaths::ConvertRelativePathToFull(TargetFilename);
+	const FString FullSourceFilename = FPaths::ConvertRelativePathToFull(SourceFilename);
+
+#if PLATFORM_WINDOWS
+	//Block cloning is only available on ReFS through the volume specific ioctl, so only hard links are supported on Windows
+	if (LinkMode == EGeneratedFileLinkMode::HardLink) {
+		return CreateHardLinkW(*FullTargetFilename.Replace(TEXT("/"), TEXT("\\")), *FullSourceFilename.Replace(TEXT("/"), TEXT("\\")), NULL) != 0;
+	}
+	return false;
+#elif PLATFORM_LINUX
+	if (LinkMode == EGeneratedFileLinkMode::HardLink) {
+		return link(TCHAR_TO_UTF8(*FullSourceFilename), TCHAR_TO_UTF8(*FullTargetFilename)) == 0;
+	}
+
+	//FICLONE shares the extents of the source file on Btrfs and XFS, and fails with EOPNOTSUPP or EXDEV everywhere else
+	const int SourceFileHandle = open(TCHAR_TO_UTF8(*FullSourceFilename), O_RDONLY | O_CLOEXEC);
+	if (SourceFileHandle < 0) {
+		return false;
+	}
+	const int TargetFileHandle = open(TCHAR_TO_UTF8(*FullTargetFilename), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+	if (TargetFileHandle < 0) {
+		close(SourceFileHandle);
+		return false;
+	}
+	const bool bCloned = ioctl(TargetFileHandle, FICLONE, SourceFileHandle) == 0;
+	close(TargetFileHandle);
+	close(SourceFileHandle);
+
+	//Do not leave the empty file behind, it would be mistaken for the generated one
+	if (!bCloned) {
+		unlink(TCHAR_TO_UTF8(*FullTargetFilename));
+	}
+	return bCloned;
+#elif PLATFORM_MAC
+	if (LinkMode == EGeneratedFileLinkMode::HardLink) {
+		return link(TCHAR_TO_UTF8(*FullSourceFilename), TCHAR_TO_UTF8(*FullTargetFilename)) == 0;
+	}
+	return clonefile(TCHAR_TO_UTF8(*FullSourceFilename), TCHAR_TO_UTF8(*FullTargetFilename), 0) == 0;
+#else
+	return false;
+#endif
+}
+
+bool FGeneratedFileLinker::ParseLinkMode(const FString& LinkModeName, EGeneratedFileLinkMode& OutLinkMode) {
+	if (LinkModeName == TEXT("copy")) {
+		OutLinkMode = EGeneratedFileLinkMode::Copy;
+	} else if (LinkModeName == TEXT("hardlink")) {
+		OutLinkMode = EGeneratedFileLinkMode::HardLink;
+	} else if (LinkModeName == TEXT("reflink")) {
+		OutLinkMode = EGeneratedFileLinkMode::Reflink;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+const TCHAR* FGeneratedFileLinker::LexToString(EGeneratedFileLinkMode LinkMode) {
+	switch (LinkMode) {
+		case EGeneratedFileLinkMode::HardLink: return TEXT("hardlink");
+		case EGeneratedFileLinkMode::Reflink: return TEXT("reflink");
+		default: return TEXT("copy");
+	}
+}
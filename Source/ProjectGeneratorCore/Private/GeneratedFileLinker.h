@@ -0,0 +1,25 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProjectGenerator.h"
+#include "HAL/ThreadSafeBool.h"
+
+/**
+ * Places the files that are carried over unchanged into the output directory
+ * Creates hard links or copy-on-write clones of the source files when requested and supported by the file system, and copies them otherwise
+ */
+class FGeneratedFileLinker {
+public:
+	explicit FGeneratedFileLinker(EGeneratedFileLinkMode InLinkMode);
+
+	/** Links or copies the source file to the target location. Sets bOutLinked when the file has been linked instead of copied. Thread safe */
+	bool LinkOrCopyFile(const FString& TargetFilename, const FString& SourceFilename, bool& bOutLinked);
+
+	static bool ParseLinkMode(const FString& LinkModeName, EGeneratedFileLinkMode& OutLinkMode);
+	static const TCHAR* LexToString(EGeneratedFileLinkMode LinkMode);
+private:
+	/** Creates the link using the native file system API, returns false when the platform or the file system does not support it */
+	static bool CreatePlatformLink(EGeneratedFileLinkMode LinkMode, const FString& TargetFilename, const FString& SourceFilename);
+
+	EGeneratedFileLinkMode LinkMode;
+	FThreadSafeBool bFallbackToCopy;
+};
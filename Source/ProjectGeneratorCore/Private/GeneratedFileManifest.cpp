@@ -0,0 +1,166 @@
+#include "GeneratedFileManifest.h"
+#include "ProjectGenerator.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/SecureHash.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+const TCHAR* FGeneratedFileManifest::ManifestFileName = TEXT("ProjectGeneratorManifest.json");
+
+bool FGeneratedFileManifest::Load(const FString& ManifestFilePath) {
+	FString ManifestFileContents;
+	if (!FFileHelper::LoadFileToString(ManifestFileContents, *ManifestFilePath)) {
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> ManifestObject;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(ManifestFileContents), ManifestObject) || !ManifestObject.IsValid()) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Failed to parse generated file manifest %s, all files will be regenerated"), *ManifestFilePath);
+		return false;
+	}
+
+	const TSharedPtr<FJsonObject>* FilesObject;
+	if (!ManifestObject->TryGetObjectField(TEXT("Files"), FilesObject)) {
+		return false;
+	}
+
+	FScopeLock ScopeLock(&FilesLock);
+	Files.Empty();
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& FileEntry : (*FilesObject)->Values) {
+		const TSharedPtr<FJsonObject> RecordObject = FileEntry.Value->AsObject();
+		if (!RecordObject.IsValid()) {
+			continue;
+		}
+		FGeneratedFileRecord& FileRecord = Files.Add(FileEntry.Key);
+		FileRecord.SourceHash = RecordObject->GetStringField(TEXT("Source"));
+		FileRecord.IncludeSetHash = RecordObject->GetStringField(TEXT("Includes"));
+		FileRecord.OutputHash = RecordObject->GetStringField(TEXT("Output"));
+	}
+	return true;
+}
+
+bool FGeneratedFileManifest::Save(const FString& ManifestFilePath) const {
+	FScopeLock ScopeLock(&FilesLock);
+
+	//Sort the files so the manifest does not change between the runs producing the same output
+	TArray<FString> RelativeFilePaths;
+	Files.GetKeys(RelativeFilePaths);
+	RelativeFilePaths.Sort();
+
+	const TSharedRef<FJsonObject> FilesObject = MakeShareable(new FJsonObject());
+	for (const FString& RelativeFilePath : RelativeFilePaths) {
+		const FGeneratedFileRecord& FileRecord = Files.FindChecked(RelativeFilePath);
+
+		const TSharedRef<FJsonObject> RecordObject = MakeShareable(new FJsonObject());
+		RecordObject->SetStringField(TEXT("Source"), FileRecord.SourceHash);
+		RecordObject->SetStringField(TEXT("Includes"), FileRecord.IncludeSetHash);
+		RecordObject->SetStringField(TEXT("Output"), FileRecord.OutputHash);
+		FilesObject->SetObjectField(RelativeFilePath, RecordObject);
+	}
+
+	const TSharedRef<FJsonObject> ManifestObject = MakeShareable(new FJsonObject());
+	ManifestObject->SetNumberField(TEXT("Version"), 1);
+	ManifestObject->SetObjectField(TEXT("Files"), FilesObject);
+
+	FString ManifestFileContents;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&ManifestFileContents);
+	if (!FJsonSerializer::Serialize(ManifestObject, JsonWriter)) {
+		return false;
+	}
+	return FFileHelper::SaveStringToFile(ManifestFileContents, *ManifestFilePath);
+}
+
+bool FGeneratedFileManifest::IsFileUpToDate(const FString& RelativeFilePath, const FString& AbsoluteFilePath, const FString& SourceHash, const FString& IncludeSetHash, FString& OutOutputHash) const {
+	FGeneratedFileRecord FileRecord;
+	{
+		FScopeLock ScopeLock(&FilesLock);
+		const FGeneratedFileRecord* ExistingFileRecord = Files.Find(RelativeFilePath);
+		if (ExistingFileRecord == NULL) {
+			return false;
+		}
+		FileRecord = *ExistingFileRecord;
+	}
+
+	if (FileRecord.SourceHash != SourceHash || FileRecord.IncludeSetHash != IncludeSetHash) {
+		return false;
+	}
+	//Make sure the file has not been removed or edited manually since it has been generated
+	if (HashFile(AbsoluteFilePath) != FileRecord.OutputHash) {
+		return false;
+	}
+	OutOutputHash = FileRecord.OutputHash;
+	return true;
+}
+
+bool FGeneratedFileManifest::FindFile(const FString& RelativeFilePath, FGeneratedFileRecord& OutFileRecord) const {
+	FScopeLock ScopeLock(&FilesLock);
+	if (const FGeneratedFileRecord* ExistingFileRecord = Files.Find(RelativeFilePath)) {
+		OutFileRecord = *ExistingFileRecord;
+		return true;
+	}
+	return false;
+}
+
+void FGeneratedFileManifest::AddFile(const FString& RelativeFilePath, const FGeneratedFileRecord& FileRecord) {
+	FScopeLock ScopeLock(&FilesLock);
+	Files.Add(RelativeFilePath, FileRecord);
+}
+
+TArray<FString> FGeneratedFileManifest::GetFilesMissingFrom(const FGeneratedFileManifest& OtherManifest) const {
+	FScopeLock ScopeLock(&FilesLock);
+	FScopeLock OtherScopeLock(&OtherManifest.FilesLock);
+
+	TArray<FString> MissingFiles;
+	for (const TPair<FString, FGeneratedFileRecord>& FileEntry : Files) {
+		if (!OtherManifest.Files.Contains(FileEntry.Key)) {
+			MissingFiles.Add(FileEntry.Key);
+		}
+	}
+	MissingFiles.Sort();
+	return MissingFiles;
+}
+
+void FGeneratedFileManifest::AddFilesInDirectory(const FGeneratedFileManifest& OtherManifest, const FString& RelativeDirectory, TArray<FString>& OutAddedFiles) {
+	FScopeLock ScopeLock(&FilesLock);
+	FScopeLock OtherScopeLock(&OtherManifest.FilesLock);
+
+	const FString DirectoryPrefix = RelativeDirectory.EndsWith(TEXT("/")) ? RelativeDirectory : RelativeDirectory + TEXT("/");
+	for (const TPair<FString, FGeneratedFileRecord>& FileEntry : OtherManifest.Files) {
+		if (FileEntry.Key.StartsWith(DirectoryPrefix)) {
+			Files.Add(FileEntry.Key, FileEntry.Value);
+			OutAddedFiles.Add(FileEntry.Key);
+		}
+	}
+}
+
+FString FGeneratedFileManifest::HashBytes(const uint8* Data, int64 Size) {
+	FMD5 Md5;
+	Md5.Update(Data, Size);
+
+	FMD5Hash ResultHash;
+	ResultHash.Set(Md5);
+	return LexToString(ResultHash);
+}
+
+FString FGeneratedFileManifest::HashFile(const FString& Filename) {
+	const FMD5Hash FileHash = FMD5Hash::HashFile(*Filename);
+	return FileHash.IsValid() ? LexToString(FileHash) : FString();
+}
+
+FString FGeneratedFileManifest::HashStrings(const TArray<FString>& Strings) {
+	FMD5 Md5;
+	for (const FString& String : Strings) {
+		const FTCHARToUTF8 StringUTF8(*String);
+		Md5.Update((const uint8*) StringUTF8.Get(), StringUTF8.Length());
+
+		//Separate the strings so the different splits of the same characters produce different hashes
+		const uint8 Separator = '\n';
+		Md5.Update(&Separator, 1);
+	}
+	FMD5Hash ResultHash;
+	ResultHash.Set(Md5);
+	return LexToString(ResultHash);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Hashes recorded for a single file generated into the output directory */
+struct FGeneratedFileRecord {
+	/** Hash of the source file inside of the header dump */
+	FString SourceHash;
+	/** Hash of the include strings the cross module includes of the file have been resolved to */
+	FString IncludeSetHash;
+	/** Hash of the file written into the output directory */
+	FString OutputHash;
+};
+
+/**
+ * Manifest of the files written into the output directory, keyed by the path relative to it
+ * Allows incremental generation to skip files which have not changed since the previous run,
+ * and to prune the files whose sources have been removed from the header dump
+ */
+class FGeneratedFileManifest {
+public:
+	static const TCHAR* ManifestFileName;
+
+	bool Load(const FString& ManifestFilePath);
+	bool Save(const FString& ManifestFilePath) const;
+
+	/** Returns true when the output file exists and has been generated from the same source and includes. Thread safe */
+	bool IsFileUpToDate(const FString& RelativeFilePath, const FString& AbsoluteFilePath, const FString& SourceHash, const FString& IncludeSetHash, FString& OutOutputHash) const;
+
+	/** Retrieves the record of the file, returns false if the file is not in the manifest. Thread safe */
+	bool FindFile(const FString& RelativeFilePath, FGeneratedFileRecord& OutFileRecord) const;
+
+	/** Records the file generated during this run. Thread safe */
+	void AddFile(const FString& RelativeFilePath, const FGeneratedFileRecord& FileRecord);
+
+	/** Returns the paths of the files recorded in this manifest that are missing from the other one */
+	TArray<FString> GetFilesMissingFrom(const FGeneratedFileManifest& OtherManifest) const;
+
+	/** Copies the records of the other manifest for the files inside of the given directory relative to the output directory, returning their paths. Thread safe */
+	void AddFilesInDirectory(const FGeneratedFileManifest& OtherManifest, const FString& RelativeDirectory, TArray<FString>& OutAddedFiles);
+
+	int32 Num() const { return Files.Num(); }
+
+	static FString HashBytes(const uint8* Data, int64 Size);
+	static FString HashFile(const FString& Filename);
+	static FString HashStrings(const TArray<FString>& Strings);
+private:
+	TMap<FString, FGeneratedFileRecord> Files;
+	mutable FCriticalSection FilesLock;
+};
@@ -0,0 +1,844 @@
+#include "HeaderDumpArchive.h"
+#include "ProjectGenerator.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Compression.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+
+//Window bits passed to zlib for the raw deflate streams of the zip entries and for the gzip streams
+static const int32 RawDeflateBitWindow = -15;
+static const int32 GzipBitWindow = 16 + 15;
+
+//Records of the zip archives are little endian regardless of the platform
+static uint16 ReadUInt16(const uint8* Data) {
+	return (uint16) (Data[0] | (Data[1] << 8));
+}
+
+static uint32 ReadUInt32(const uint8* Data) {
+	return (uint32) Data[0] | ((uint32) Data[1] << 8) | ((uint32) Data[2] << 16) | ((uint32) Data[3] << 24);
+}
+
+static uint64 ReadUInt64(const uint8* Data) {
+	return (uint64) ReadUInt32(Data) | ((uint64) ReadUInt32(Data + 4) << 32);
+}
+
+//Entry names use forward slashes relative to the archive root, without the leading ./ emitted by some of the tar implementations
+static FString NormalizeEntryName(const FString& EntryName) {
+	FString Result = EntryName.Replace(TEXT("\\"), TEXT("/"));
+	while (Result.StartsWith(TEXT("./"))) {
+		Result = Result.Mid(2);
+	}
+	while (Result.StartsWith(TEXT("/"))) {
+		Result = Result.Mid(1);
+	}
+	while (Result.EndsWith(TEXT("/"))) {
+		Result = Result.LeftChop(1);
+	}
+	return Result;
+}
+
+//Tar header fields are NUL terminated unless they take the whole field
+static FString ReadTarString(const uint8* Field, int32 FieldLength) {
+	int32 Length = 0;
+	while (Length < FieldLength && Field[Length] != 0) {
+		Length++;
+	}
+	const FUTF8ToTCHAR StringConverter((const ANSICHAR*) Field, Length);
+	return FString(StringConverter.Length(), StringConverter.Get());
+}
+
+//Tar numbers are octal, or big endian binary with the high bit of the first byte set when they do not fit into the octal digits
+static int64 ReadTarNumber(const uint8* Field, int32 FieldLength) {
+	int64 Result = 0;
+	if (Field[0] & 0x80) {
+		Result = Field[0] & 0x7F;
+		for (int32 Index = 1; Index < FieldLength; Index++) {
+			Result = (Result << 8) | Field[Index];
+		}
+		return Result;
+	}
+	int32 Index = 0;
+	while (Index < FieldLength && Field[Index] == ' ') {
+		Index++;
+	}
+	for (; Index < FieldLength && Field[Index] >= '0' && Field[Index] <= '7'; Index++) {
+		Result = (Result << 3) | (Field[Index] - '0');
+	}
+	return Result;
+}
+
+/** Reads the single file of the archive, either from the memory buffer or from the window of the archive file */
+class FHeaderDumpArchiveFileHandle : public IFileHandle {
+public:
+	FHeaderDumpArchiveFileHandle(const TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe>& InBuffer, int64 InDataOffset, int64 InDataSize) :
+		Buffer(InBuffer), DataOffset(InDataOffset), DataSize(InDataSize), Position(0) {
+	}
+
+	FHeaderDumpArchiveFileHandle(const TSharedRef<FHeaderDumpArchive, ESPMode::ThreadSafe>& InArchive, TUniquePtr<IFileHandle> InArchiveHandle, int64 InDataOffset, int64 InDataSize) :
+		Archive(InArchive), ArchiveHandle(MoveTemp(InArchiveHandle)), DataOffset(InDataOffset), DataSize(InDataSize), Position(0) {
+	}
+
+	virtual ~FHeaderDumpArchiveFileHandle() override {
+		if (Archive.IsValid()) {
+			Archive->ReleaseArchiveHandle(MoveTemp(ArchiveHandle));
+		}
+	}
+
+	virtual int64 Tell() override {
+		return Position;
+	}
+
+	virtual bool Seek(int64 NewPosition) override {
+		if (NewPosition < 0 || NewPosition > DataSize) {
+			return false;
+		}
+		Position = NewPosition;
+		return true;
+	}
+
+	virtual bool SeekFromEnd(int64 NewPositionRelativeToEnd) override {
+		return Seek(DataSize + NewPositionRelativeToEnd);
+	}
+
+	virtual bool Read(uint8* Destination, int64 BytesToRead) override {
+		if (BytesToRead < 0 || Position + BytesToRead > DataSize) {
+			return false;
+		}
+		if (Buffer.IsValid()) {
+			FMemory::Memcpy(Destination, Buffer->GetData() + DataOffset + Position, BytesToRead);
+		} else if (!ArchiveHandle->Seek(DataOffset + Position) || !ArchiveHandle->Read(Destination, BytesToRead)) {
+			return false;
+		}
+		Position += BytesToRead;
+		return true;
+	}
+
+	virtual bool Write(const uint8* Source, int64 BytesToWrite) override {
+		return false;
+	}
+
+	virtual bool Flush(const bool bFullFlush) override {
+		return true;
+	}
+
+	virtual bool Truncate(int64 NewSize) override {
+		return false;
+	}
+
+	virtual int64 Size() override {
+		return DataSize;
+	}
+private:
+	TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> Buffer;
+	TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive;
+	TUniquePtr<IFileHandle> ArchiveHandle;
+	int64 DataOffset;
+	int64 DataSize;
+	int64 Position;
+};
+
+FHeaderDumpArchive::FHeaderDumpArchive(IPlatformFile& InArchivePlatformFile, const FString& InArchiveFilename) : ArchivePlatformFile(InArchivePlatformFile), ArchiveFilename(InArchiveFilename) {
+}
+
+bool FHeaderDumpArchive::IsArchiveFilename(const FString& Filename) {
+	static const TCHAR* ArchiveExtensions[] = {TEXT(".zip"), TEXT(".tar"), TEXT(".tar.gz"), TEXT(".tgz"), TEXT(".tar.zst"), TEXT(".tzst")};
+
+	for (const TCHAR* ArchiveExtension : ArchiveExtensions) {
+		if (Filename.EndsWith(ArchiveExtension)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> FHeaderDumpArchive::Open(IPlatformFile& InArchivePlatformFile, const FString& InArchiveFilename, FString& OutErrorMessage) {
+	//Engine does not ship the Zstandard library, so these are recognized only to tell how to repack them
+	if (InArchiveFilename.EndsWith(TEXT(".tar.zst")) || InArchiveFilename.EndsWith(TEXT(".tzst"))) {
+		OutErrorMessage = TEXT("Zstandard compressed archives are not supported, repack the header dump as .zip, .tar or .tar.gz");
+		return NULL;
+	}
+
+	const TSharedRef<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = MakeShareable(new FHeaderDumpArchive(InArchivePlatformFile, InArchiveFilename));
+	Archive->TimeStamp = InArchivePlatformFile.GetTimeStamp(*InArchiveFilename);
+
+	TArray<TPair<FString, FHeaderDumpArchiveEntry>> FoundFiles;
+	TArray<FString> FoundDirectories;
+
+	if (InArchiveFilename.EndsWith(TEXT(".zip"))) {
+		if (!Archive->ReadZipIndex(FoundFiles, FoundDirectories, OutErrorMessage)) {
+			return NULL;
+		}
+	} else if (InArchiveFilename.EndsWith(TEXT(".tar.gz")) || InArchiveFilename.EndsWith(TEXT(".tgz"))) {
+		if (!Archive->InflateGzipArchive(OutErrorMessage)) {
+			return NULL;
+		}
+		const TArray<uint8>& TarContents = *Archive->InflatedContents;
+		auto ReadInflatedData = [&](int64 Offset, uint8* Destination, int64 Size) {
+			FMemory::Memcpy(Destination, TarContents.GetData() + Offset, Size);
+			return true;
+		};
+		if (!Archive->ReadTarIndex(TarContents.Num(), ReadInflatedData, FoundFiles, FoundDirectories, OutErrorMessage)) {
+			return NULL;
+		}
+	} else {
+		TUniquePtr<IFileHandle> ArchiveHandle(InArchivePlatformFile.OpenRead(*InArchiveFilename));
+		if (!ArchiveHandle.IsValid()) {
+			OutErrorMessage = TEXT("Cannot open the archive for reading");
+			return NULL;
+		}
+		auto ReadArchiveData = [&](int64 Offset, uint8* Destination, int64 Size) {
+			return ArchiveHandle->Seek(Offset) && ArchiveHandle->Read(Destination, Size);
+		};
+		if (!Archive->ReadTarIndex(ArchiveHandle->Size(), ReadArchiveData, FoundFiles, FoundDirectories, OutErrorMessage)) {
+			return NULL;
+		}
+	}
+	Archive->AddEntries(FoundFiles, FoundDirectories);
+	return Archive;
+}
+
+bool FHeaderDumpArchive::ReadZipIndex(TArray<TPair<FString, FHeaderDumpArchiveEntry>>& OutFiles, TArray<FString>& OutDirectories, FString& OutErrorMessage) {
+	TUniquePtr<IFileHandle> ArchiveHandle(ArchivePlatformFile.OpenRead(*ArchiveFilename));
+	if (!ArchiveHandle.IsValid()) {
+		OutErrorMessage = TEXT("Cannot open the archive for reading");
+		return false;
+	}
+
+	//End of central directory record is at the end of the archive, followed by the comment of up to 64 KB
+	const int32 EndRecordSize = 22;
+	const int64 ArchiveSize = ArchiveHandle->Size();
+	const int64 TailSize = FMath::Min<int64>(ArchiveSize, EndRecordSize + MAX_uint16);
+
+	TArray<uint8> Tail;
+	Tail.SetNumUninitialized((int32) TailSize);
+	if (!ArchiveHandle->Seek(ArchiveSize - TailSize) || !ArchiveHandle->Read(Tail.GetData(), TailSize)) {
+		OutErrorMessage = TEXT("Cannot read the end of the archive");
+		return false;
+	}
+
+	int32 EndRecordOffset = INDEX_NONE;
+	for (int32 Offset = Tail.Num() - EndRecordSize; Offset >= 0; Offset--) {
+		if (ReadUInt32(Tail.GetData() + Offset) == 0x06054b50) {
+			EndRecordOffset = Offset;
+			break;
+		}
+	}
+	if (EndRecordOffset == INDEX_NONE) {
+		OutErrorMessage = TEXT("End of central directory record not found, the archive is not a zip file or has been truncated");
+		return false;
+	}
+
+	const uint8* EndRecord = Tail.GetData() + EndRecordOffset;
+	uint64 NumEntries = ReadUInt16(EndRecord + 10);
+	uint64 DirectorySize = ReadUInt32(EndRecord + 12);
+	uint64 DirectoryOffset = ReadUInt32(EndRecord + 16);
+
+	//Archives with more than 65535 entries or larger than 4 GB keep the real values in the zip64 record, pointed to by the locator right before the regular one
+	const int32 LocatorSize = 20;
+	if (EndRecordOffset >= LocatorSize && ReadUInt32(EndRecord - LocatorSize) == 0x07064b50) {
+		uint8 Zip64EndRecord[56];
+		if (!ArchiveHandle->Seek(ReadUInt64(EndRecord - LocatorSize + 8)) || !ArchiveHandle->Read(Zip64EndRecord, sizeof(Zip64EndRecord)) || ReadUInt32(Zip64EndRecord) != 0x06064b50) {
+			OutErrorMessage = TEXT("Malformed zip64 end of central directory record");
+			return false;
+		}
+		NumEntries = ReadUInt64(Zip64EndRecord + 32);
+		DirectorySize = ReadUInt64(Zip64EndRecord + 40);
+		DirectoryOffset = ReadUInt64(Zip64EndRecord + 48);
+	}
+
+	if (DirectoryOffset + DirectorySize > (uint64) ArchiveSize || DirectorySize > MAX_int32) {
+		OutErrorMessage = TEXT("Central directory is outside of the archive");
+		return false;
+	}
+	TArray<uint8> Directory;
+	Directory.SetNumUninitialized((int32) DirectorySize);
+	if (!ArchiveHandle->Seek(DirectoryOffset) || !ArchiveHandle->Read(Directory.GetData(), DirectorySize)) {
+		OutErrorMessage = TEXT("Cannot read the central directory");
+		return false;
+	}
+
+	const int32 HeaderSize = 46;
+	int64 Cursor = 0;
+	for (uint64 EntryIndex = 0; EntryIndex < NumEntries; EntryIndex++) {
+		const uint8* Header = Directory.GetData() + Cursor;
+		if (Cursor + HeaderSize > Directory.Num() || ReadUInt32(Header) != 0x02014b50) {
+			OutErrorMessage = TEXT("Malformed central directory");
+			return false;
+		}
+		const uint16 Flags = ReadUInt16(Header + 8);
+		const uint16 Method = ReadUInt16(Header + 10);
+		uint64 CompressedSize = ReadUInt32(Header + 20);
+		uint64 Size = ReadUInt32(Header + 24);
+		const uint16 NameLength = ReadUInt16(Header + 28);
+		const uint16 ExtraLength = ReadUInt16(Header + 30);
+		const uint16 CommentLength = ReadUInt16(Header + 32);
+		uint64 LocalHeaderOffset = ReadUInt32(Header + 42);
+
+		const int64 RecordSize = HeaderSize + NameLength + ExtraLength + CommentLength;
+		if (Cursor + RecordSize > Directory.Num()) {
+			OutErrorMessage = TEXT("Malformed central directory");
+			return false;
+		}
+		const FUTF8ToTCHAR NameConverter((const ANSICHAR*) Header + HeaderSize, NameLength);
+		const FString EntryName(NameConverter.Length(), NameConverter.Get());
+
+		//Sizes and the offset that do not fit into 32 bits are moved into the zip64 extra field, in this order
+		const uint8* Extra = Header + HeaderSize + NameLength;
+		const uint8* ExtraEnd = Extra + ExtraLength;
+		while (Extra + 4 <= ExtraEnd) {
+			const uint16 ExtraId = ReadUInt16(Extra);
+			const uint8* Field = Extra + 4;
+			const uint8* FieldEnd = FMath::Min(Field + ReadUInt16(Extra + 2), ExtraEnd);
+
+			if (ExtraId == 0x0001) {
+				if (Size == MAX_uint32 && Field + 8 <= FieldEnd) {
+					Size = ReadUInt64(Field);
+					Field += 8;
+				}
+				if (CompressedSize == MAX_uint32 && Field + 8 <= FieldEnd) {
+					CompressedSize = ReadUInt64(Field);
+					Field += 8;
+				}
+				if (LocalHeaderOffset == MAX_uint32 && Field + 8 <= FieldEnd) {
+					LocalHeaderOffset = ReadUInt64(Field);
+				}
+			}
+			Extra = FieldEnd;
+		}
+		Cursor += RecordSize;
+
+		if (EntryName.EndsWith(TEXT("/"))) {
+			OutDirectories.Add(NormalizeEntryName(EntryName));
+			continue;
+		}
+		if (Flags & 0x1) {
+			OutErrorMessage = FString::Printf(TEXT("File %s is encrypted"), *EntryName);
+			return false;
+		}
+		if (Method != 0 && Method != 8) {
+			OutErrorMessage = FString::Printf(TEXT("File %s uses the compression method %d, only stored and deflated files are supported"), *EntryName, Method);
+			return false;
+		}
+		//Deflated files are inflated into memory as a whole, so they are limited by the array size
+		if (Method == 8 && (Size > MAX_int32 || CompressedSize > MAX_int32)) {
+			OutErrorMessage = FString::Printf(TEXT("Deflated file %s is too large to be inflated into memory"), *EntryName);
+			return false;
+		}
+
+		FHeaderDumpArchiveEntry Entry;
+		Entry.Offset = LocalHeaderOffset;
+		Entry.CompressedSize = CompressedSize;
+		Entry.Size = Size;
+		Entry.bIsDeflated = Method == 8;
+		Entry.bHasLocalHeader = true;
+		OutFiles.Add(TPair<FString, FHeaderDumpArchiveEntry>(NormalizeEntryName(EntryName), Entry));
+	}
+	return true;
+}
+
+bool FHeaderDumpArchive::ReadTarIndex(int64 ArchiveSize, TFunctionRef<bool(int64, uint8*, int64)> ReadArchiveData, TArray<TPair<FString, FHeaderDumpArchiveEntry>>& OutFiles, TArray<FString>& OutDirectories, FString& OutErrorMessage) {
+	const int32 BlockSize = 512;
+	uint8 Header[BlockSize];
+	int64 Offset = 0;
+
+	//Names longer than the header fields come from the GNU long name or the pax extended header preceding the entry
+	FString LongEntryName;
+
+	while (Offset + BlockSize <= ArchiveSize) {
+		if (!ReadArchiveData(Offset, Header, BlockSize)) {
+			OutErrorMessage = TEXT("Cannot read the tar header");
+			return false;
+		}
+
+		//Archive is terminated by the two zero blocks, the first one is enough to stop
+		bool bIsZeroBlock = true;
+		for (int32 Index = 0; Index < BlockSize && bIsZeroBlock; Index++) {
+			bIsZeroBlock = Header[Index] == 0;
+		}
+		if (bIsZeroBlock) {
+			break;
+		}
+
+		const int64 EntrySize = ReadTarNumber(Header + 124, 12);
+		const uint8 TypeFlag = Header[156];
+		const int64 DataOffset = Offset + BlockSize;
+		if (EntrySize < 0 || DataOffset + EntrySize > ArchiveSize) {
+			OutErrorMessage = FString::Printf(TEXT("Tar entry at offset %lld is truncated"), Offset);
+			return false;
+		}
+		Offset = DataOffset + Align(EntrySize, BlockSize);
+
+		if (TypeFlag == 'L' || TypeFlag == 'x') {
+			TArray<uint8> ExtendedHeader;
+			ExtendedHeader.SetNumUninitialized((int32) EntrySize);
+			if (!ReadArchiveData(DataOffset, ExtendedHeader.GetData(), EntrySize)) {
+				OutErrorMessage = TEXT("Cannot read the tar extended header");
+				return false;
+			}
+			if (TypeFlag == 'L') {
+				LongEntryName = ReadTarString(ExtendedHeader.GetData(), ExtendedHeader.Num());
+				continue;
+			}
+
+			//Pax records are formatted as "<Length> <Key>=<Value>\n", where the length includes the whole record
+			int32 RecordStart = 0;
+			while (RecordStart < ExtendedHeader.Num()) {
+				int32 RecordLength = 0;
+				int32 KeyStart = RecordStart;
+				while (KeyStart < ExtendedHeader.Num() && ExtendedHeader[KeyStart] >= '0' && ExtendedHeader[KeyStart] <= '9') {
+					RecordLength = RecordLength * 10 + (ExtendedHeader[KeyStart++] - '0');
+				}
+				if (RecordStart + RecordLength > ExtendedHeader.Num() || KeyStart + 2 > RecordStart + RecordLength) {
+					break;
+				}
+				const FString Record = ReadTarString(ExtendedHeader.GetData() + KeyStart + 1, RecordStart + RecordLength - KeyStart - 2);
+				if (Record.StartsWith(TEXT("path="), ESearchCase::CaseSensitive)) {
+					LongEntryName = Record.Mid(5);
+				}
+				RecordStart += RecordLength;
+			}
+			continue;
+		}
+
+		FString EntryName = LongEntryName;
+		LongEntryName.Reset();
+		if (EntryName.IsEmpty()) {
+			EntryName = ReadTarString(Header, 100);
+
+			//Ustar archives split the long names between the prefix and the name fields
+			if (FMemory::Memcmp(Header + 257, "ustar", 5) == 0 && Header[345] != 0) {
+				EntryName = ReadTarString(Header + 345, 155) / EntryName;
+			}
+		}
+
+		if (TypeFlag == '5') {
+			OutDirectories.Add(NormalizeEntryName(EntryName));
+		} else if (TypeFlag == '0' || TypeFlag == 0 || TypeFlag == '7') {
+			FHeaderDumpArchiveEntry Entry;
+			Entry.Offset = DataOffset;
+			Entry.CompressedSize = EntrySize;
+			Entry.Size = EntrySize;
+			OutFiles.Add(TPair<FString, FHeaderDumpArchiveEntry>(NormalizeEntryName(EntryName), Entry));
+		}
+		//Links, devices and global pax headers have nothing to do with the header dump and are skipped
+	}
+	return true;
+}
+
+bool FHeaderDumpArchive::InflateGzipArchive(FString& OutErrorMessage) {
+	TArray<uint8> CompressedContents;
+	{
+		TUniquePtr<IFileHandle> ArchiveHandle(ArchivePlatformFile.OpenRead(*ArchiveFilename));
+		if (!ArchiveHandle.IsValid() || ArchiveHandle->Size() < 18 || ArchiveHandle->Size() > MAX_int32) {
+			OutErrorMessage = TEXT("Cannot open the archive for reading, or it is too large to be inflated into memory");
+			return false;
+		}
+		CompressedContents.SetNumUninitialized((int32) ArchiveHandle->Size());
+		if (!ArchiveHandle->Read(CompressedContents.GetData(), CompressedContents.Num())) {
+			OutErrorMessage = TEXT("Cannot read the archive");
+			return false;
+		}
+	}
+
+	//Gzip stream ends with the size of the inflated data modulo 4 GB, which is exact as long as the data fits into memory at all
+	const uint32 InflatedSize = ReadUInt32(CompressedContents.GetData() + CompressedContents.Num() - 4);
+	if (InflatedSize > MAX_int32) {
+		OutErrorMessage = TEXT("Archive is too large to be inflated into memory, repack the header dump as .zip or .tar");
+		return false;
+	}
+
+	InflatedContents = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+	InflatedContents->SetNumUninitialized((int32) InflatedSize);
+	if (!FCompression::UncompressMemory(NAME_Zlib, InflatedContents->GetData(), InflatedContents->Num(), CompressedContents.GetData(), CompressedContents.Num(), COMPRESS_NoFlags, GzipBitWindow)) {
+		OutErrorMessage = TEXT("Cannot inflate the archive, it is either corrupted or consists of multiple gzip members");
+		return false;
+	}
+	return true;
+}
+
+void FHeaderDumpArchive::AddEntries(const TArray<TPair<FString, FHeaderDumpArchiveEntry>>& FoundFiles, const TArray<FString>& FoundDirectories) {
+	//Archives are often made from the dump directory itself rather than from its contents, in which case it becomes the root
+	FString RootDirectory;
+	bool bHasSingleRootDirectory = FoundFiles.Num() > 0;
+
+	for (const TPair<FString, FHeaderDumpArchiveEntry>& FoundFile : FoundFiles) {
+		FString FirstDirectory;
+		if (!FoundFile.Key.Split(TEXT("/"), &FirstDirectory, NULL) || (!RootDirectory.IsEmpty() && FirstDirectory != RootDirectory)) {
+			bHasSingleRootDirectory = false;
+			break;
+		}
+		RootDirectory = FirstDirectory;
+	}
+
+	//Dump of the single module has the module directory as its only root, which has to be kept as it is
+	if (bHasSingleRootDirectory) {
+		const FString ModuleRootPrefix = RootDirectory / TEXT("");
+		for (const TPair<FString, FHeaderDumpArchiveEntry>& FoundFile : FoundFiles) {
+			const FString PathInsideRoot = FoundFile.Key.Mid(ModuleRootPrefix.Len());
+			if ((!PathInsideRoot.Contains(TEXT("/")) && PathInsideRoot.EndsWith(TEXT(".Build.cs"))) || PathInsideRoot.StartsWith(TEXT("Public/")) ||
+				PathInsideRoot.StartsWith(TEXT("Private/")) || PathInsideRoot.StartsWith(TEXT("Classes/"))) {
+				bHasSingleRootDirectory = false;
+				break;
+			}
+		}
+	}
+	const FString RootPrefix = bHasSingleRootDirectory ? RootDirectory / TEXT("") : FString();
+
+	auto StripRootDirectory = [&](const FString& Path) {
+		return Path.StartsWith(RootPrefix) ? Path.Mid(RootPrefix.Len()) : FString();
+	};
+
+	Directories.Add(FString());
+	for (const FString& FoundDirectory : FoundDirectories) {
+		AddDirectoryEntry(StripRootDirectory(FoundDirectory / TEXT("")).LeftChop(1), true);
+	}
+
+	//Later copies of the same file replace the earlier ones, like they do when the archive is extracted
+	for (const TPair<FString, FHeaderDumpArchiveEntry>& FoundFile : FoundFiles) {
+		const FString RelativeFilename = StripRootDirectory(FoundFile.Key);
+		if (RelativeFilename.IsEmpty()) {
+			continue;
+		}
+		if (!Files.Contains(RelativeFilename)) {
+			AddDirectoryEntry(RelativeFilename, false);
+		}
+		Files.Add(RelativeFilename, FoundFile.Value);
+	}
+}
+
+void FHeaderDumpArchive::AddDirectoryEntry(const FString& Path, bool bIsDirectory) {
+	if (bIsDirectory) {
+		if (Path.IsEmpty() || Directories.Contains(Path)) {
+			return;
+		}
+		Directories.Add(Path);
+	}
+
+	FString ParentDirectory;
+	FString Name = Path;
+	Path.Split(TEXT("/"), &ParentDirectory, &Name, ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+
+	AddDirectoryEntry(ParentDirectory, true);
+	Directories.FindChecked(ParentDirectory).Add(FHeaderDumpArchiveDirectoryEntry{Name, bIsDirectory});
+}
+
+const FHeaderDumpArchiveEntry* FHeaderDumpArchive::FindFile(const FString& RelativeFilename) const {
+	return Files.Find(RelativeFilename);
+}
+
+bool FHeaderDumpArchive::DirectoryExists(const FString& RelativeDirectory) const {
+	return Directories.Contains(RelativeDirectory);
+}
+
+bool FHeaderDumpArchive::IterateDirectory(const FString& RelativeDirectory, TFunctionRef<bool(const FHeaderDumpArchiveDirectoryEntry&)> Visitor) const {
+	const TArray<FHeaderDumpArchiveDirectoryEntry>* DirectoryEntries = Directories.Find(RelativeDirectory);
+	if (DirectoryEntries == NULL) {
+		return false;
+	}
+	for (const FHeaderDumpArchiveDirectoryEntry& DirectoryEntry : *DirectoryEntries) {
+		if (!Visitor(DirectoryEntry)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+IFileHandle* FHeaderDumpArchive::OpenFile(const FString& RelativeFilename) {
+	const FHeaderDumpArchiveEntry* Entry = Files.Find(RelativeFilename);
+	if (Entry == NULL) {
+		return NULL;
+	}
+
+	//Files of the inflated tar archive are read straight from memory
+	if (InflatedContents.IsValid()) {
+		return new FHeaderDumpArchiveFileHandle(InflatedContents, Entry->Offset, Entry->Size);
+	}
+
+	TUniquePtr<IFileHandle> ArchiveHandle = AcquireArchiveHandle();
+	if (!ArchiveHandle.IsValid()) {
+		return NULL;
+	}
+
+	//Local file header repeats the name and has its own extra field, so the data offset is only known after reading it
+	int64 DataOffset = Entry->Offset;
+	if (Entry->bHasLocalHeader) {
+		uint8 LocalHeader[30];
+		if (!ArchiveHandle->Seek(Entry->Offset) || !ArchiveHandle->Read(LocalHeader, sizeof(LocalHeader)) || ReadUInt32(LocalHeader) != 0x04034b50) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Malformed local file header of %s inside of the archive %s"), *RelativeFilename, *ArchiveFilename);
+			ReleaseArchiveHandle(MoveTemp(ArchiveHandle));
+			return NULL;
+		}
+		DataOffset += sizeof(LocalHeader) + ReadUInt16(LocalHeader + 26) + ReadUInt16(LocalHeader + 28);
+	}
+
+	//Stored files are read from the archive as needed, so they can still be streamed
+	if (!Entry->bIsDeflated) {
+		return new FHeaderDumpArchiveFileHandle(AsShared(), MoveTemp(ArchiveHandle), DataOffset, Entry->Size);
+	}
+
+	TArray<uint8> CompressedContents;
+	CompressedContents.SetNumUninitialized((int32) Entry->CompressedSize);
+	const bool bReadSucceeded = ArchiveHandle->Seek(DataOffset) && ArchiveHandle->Read(CompressedContents.GetData(), CompressedContents.Num());
+	ReleaseArchiveHandle(MoveTemp(ArchiveHandle));
+
+	const TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> Contents = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+	Contents->SetNumUninitialized((int32) Entry->Size);
+
+	if (!bReadSucceeded || (Contents->Num() && !FCompression::UncompressMemory(NAME_Zlib, Contents->GetData(), Contents->Num(), CompressedContents.GetData(), CompressedContents.Num(), COMPRESS_NoFlags, RawDeflateBitWindow))) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Cannot inflate %s inside of the archive %s"), *RelativeFilename, *ArchiveFilename);
+		return NULL;
+	}
+	return new FHeaderDumpArchiveFileHandle(Contents, 0, Entry->Size);
+}
+
+TUniquePtr<IFileHandle> FHeaderDumpArchive::AcquireArchiveHandle() {
+	{
+		FScopeLock ScopeLock(&ArchiveHandlesLock);
+		if (ArchiveHandles.Num()) {
+			return ArchiveHandles.Pop(false);
+		}
+	}
+	TUniquePtr<IFileHandle> ArchiveHandle(ArchivePlatformFile.OpenRead(*ArchiveFilename));
+	if (!ArchiveHandle.IsValid()) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Cannot open the archive %s for reading"), *ArchiveFilename);
+	}
+	return ArchiveHandle;
+}
+
+void FHeaderDumpArchive::ReleaseArchiveHandle(TUniquePtr<IFileHandle> ArchiveHandle) {
+	FScopeLock ScopeLock(&ArchiveHandlesLock);
+	ArchiveHandles.Add(MoveTemp(ArchiveHandle));
+}
+
+//Never destroyed, the platform file manager keeps using it until the exit
+static FHeaderDumpArchivePlatformFile* GHeaderDumpArchivePlatformFile = NULL;
+
+FHeaderDumpArchivePlatformFile::FHeaderDumpArchivePlatformFile() : LowerLevel(NULL) {
+}
+
+bool FHeaderDumpArchivePlatformFile::MountArchive(const FString& ArchiveFilename, FString& OutErrorMessage) {
+	if (GHeaderDumpArchivePlatformFile == NULL) {
+		GHeaderDumpArchivePlatformFile = new FHeaderDumpArchivePlatformFile();
+		GHeaderDumpArchivePlatformFile->Initialize(&FPlatformFileManager::Get().GetPlatformFile(), TEXT(""));
+		FPlatformFileManager::Get().SetPlatformFile(*GHeaderDumpArchivePlatformFile);
+	}
+
+	const FString FullArchiveFilename = FPaths::ConvertRelativePathToFull(ArchiveFilename);
+	{
+		FReadScopeLock ReadLock(GHeaderDumpArchivePlatformFile->MountedArchivesLock);
+		if (GHeaderDumpArchivePlatformFile->MountedArchives.Contains(FullArchiveFilename)) {
+			return true;
+		}
+	}
+
+	IPlatformFile& ArchivePlatformFile = *GHeaderDumpArchivePlatformFile->LowerLevel;
+	if (!ArchivePlatformFile.FileExists(*FullArchiveFilename)) {
+		OutErrorMessage = TEXT("Archive does not exist");
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FHeaderDumpArchive::Open(ArchivePlatformFile, FullArchiveFilename, OutErrorMessage);
+	if (!Archive.IsValid()) {
+		return false;
+	}
+	UE_LOG(LogProjectGenerator, Display, TEXT("Mounted header dump archive %s with %d files in %.2f seconds"), *ArchiveFilename, Archive->Num(), FPlatformTime::Seconds() - StartTime);
+
+	FWriteScopeLock WriteLock(GHeaderDumpArchivePlatformFile->MountedArchivesLock);
+	GHeaderDumpArchivePlatformFile->MountedArchives.Add(FullArchiveFilename, Archive);
+	GHeaderDumpArchivePlatformFile->MountedArchiveNames.Add(FPaths::GetCleanFilename(FullArchiveFilename));
+	GHeaderDumpArchivePlatformFile->NumMountedArchives.Increment();
+	return true;
+}
+
+bool FHeaderDumpArchivePlatformFile::IsMountedArchive(const FString& Path) {
+	if (GHeaderDumpArchivePlatformFile == NULL) {
+		return false;
+	}
+	FReadScopeLock ReadLock(GHeaderDumpArchivePlatformFile->MountedArchivesLock);
+	return GHeaderDumpArchivePlatformFile->MountedArchives.Contains(FPaths::ConvertRelativePathToFull(Path));
+}
+
+TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> FHeaderDumpArchivePlatformFile::FindArchive(const TCHAR* Path, FString& OutRelativePath) const {
+	//Most of the calls are made for the files outside of the archives, like the ones of the output directory or the engine,
+	//and any path inside of the archive has to name it, so the rest are rejected without normalizing them or waiting for the writers
+	if (NumMountedArchives.GetValue() == 0) {
+		return NULL;
+	}
+	FReadScopeLock ReadLock(MountedArchivesLock);
+	const bool bMayBeInsideArchive = MountedArchiveNames.ContainsByPredicate([&](const FString& ArchiveName) {
+		return FCString::Stristr(Path, *ArchiveName) != NULL;
+	});
+	if (!bMayBeInsideArchive) {
+		return NULL;
+	}
+
+	const FString FullPath = FPaths::ConvertRelativePathToFull(Path);
+	for (const TPair<FString, TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe>>& MountedArchive : MountedArchives) {
+		if (FullPath == MountedArchive.Key) {
+			OutRelativePath.Reset();
+			return MountedArchive.Value;
+		}
+		if (FullPath.Len() > MountedArchive.Key.Len() && FullPath[MountedArchive.Key.Len()] == TEXT('/') && FullPath.StartsWith(MountedArchive.Key)) {
+			OutRelativePath = FullPath.Mid(MountedArchive.Key.Len() + 1);
+			return MountedArchive.Value;
+		}
+	}
+	return NULL;
+}
+
+bool FHeaderDumpArchivePlatformFile::Initialize(IPlatformFile* Inner, const TCHAR* CmdLine) {
+	LowerLevel = Inner;
+	return LowerLevel != NULL;
+}
+
+bool FHeaderDumpArchivePlatformFile::FileExists(const TCHAR* Filename) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(Filename, RelativePath)) {
+		return Archive->FindFile(RelativePath) != NULL;
+	}
+	return LowerLevel->FileExists(Filename);
+}
+
+int64 FHeaderDumpArchivePlatformFile::FileSize(const TCHAR* Filename) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(Filename, RelativePath)) {
+		const FHeaderDumpArchiveEntry* Entry = Archive->FindFile(RelativePath);
+		return Entry != NULL ? Entry->Size : -1;
+	}
+	return LowerLevel->FileSize(Filename);
+}
+
+bool FHeaderDumpArchivePlatformFile::DeleteFile(const TCHAR* Filename) {
+	FString RelativePath;
+	return !FindArchive(Filename, RelativePath).IsValid() && LowerLevel->DeleteFile(Filename);
+}
+
+bool FHeaderDumpArchivePlatformFile::IsReadOnly(const TCHAR* Filename) {
+	FString RelativePath;
+	return FindArchive(Filename, RelativePath).IsValid() || LowerLevel->IsReadOnly(Filename);
+}
+
+bool FHeaderDumpArchivePlatformFile::MoveFile(const TCHAR* To, const TCHAR* From) {
+	FString RelativePath;
+	return !FindArchive(To, RelativePath).IsValid() && !FindArchive(From, RelativePath).IsValid() && LowerLevel->MoveFile(To, From);
+}
+
+bool FHeaderDumpArchivePlatformFile::SetReadOnly(const TCHAR* Filename, bool bNewReadOnlyValue) {
+	FString RelativePath;
+	return !FindArchive(Filename, RelativePath).IsValid() && LowerLevel->SetReadOnly(Filename, bNewReadOnlyValue);
+}
+
+FDateTime FHeaderDumpArchivePlatformFile::GetTimeStamp(const TCHAR* Filename) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(Filename, RelativePath)) {
+		return Archive->GetTimeStamp();
+	}
+	return LowerLevel->GetTimeStamp(Filename);
+}
+
+void FHeaderDumpArchivePlatformFile::SetTimeStamp(const TCHAR* Filename, FDateTime DateTime) {
+	FString RelativePath;
+	if (!FindArchive(Filename, RelativePath).IsValid()) {
+		LowerLevel->SetTimeStamp(Filename, DateTime);
+	}
+}
+
+FDateTime FHeaderDumpArchivePlatformFile::GetAccessTimeStamp(const TCHAR* Filename) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(Filename, RelativePath)) {
+		return Archive->GetTimeStamp();
+	}
+	return LowerLevel->GetAccessTimeStamp(Filename);
+}
+
+FString FHeaderDumpArchivePlatformFile::GetFilenameOnDisk(const TCHAR* Filename) {
+	FString RelativePath;
+	if (FindArchive(Filename, RelativePath).IsValid()) {
+		return Filename;
+	}
+	return LowerLevel->GetFilenameOnDisk(Filename);
+}
+
+IFileHandle* FHeaderDumpArchivePlatformFile::OpenRead(const TCHAR* Filename, bool bAllowWrite) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(Filename, RelativePath)) {
+		return Archive->OpenFile(RelativePath);
+	}
+	return LowerLevel->OpenRead(Filename, bAllowWrite);
+}
+
+IFileHandle* FHeaderDumpArchivePlatformFile::OpenWrite(const TCHAR* Filename, bool bAppend, bool bAllowRead) {
+	FString RelativePath;
+	if (FindArchive(Filename, RelativePath).IsValid()) {
+		return NULL;
+	}
+	return LowerLevel->OpenWrite(Filename, bAppend, bAllowRead);
+}
+
+bool FHeaderDumpArchivePlatformFile::DirectoryExists(const TCHAR* Directory) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(Directory, RelativePath)) {
+		return Archive->DirectoryExists(RelativePath);
+	}
+	return LowerLevel->DirectoryExists(Directory);
+}
+
+bool FHeaderDumpArchivePlatformFile::CreateDirectory(const TCHAR* Directory) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(Directory, RelativePath)) {
+		return Archive->DirectoryExists(RelativePath);
+	}
+	return LowerLevel->CreateDirectory(Directory);
+}
+
+bool FHeaderDumpArchivePlatformFile::DeleteDirectory(const TCHAR* Directory) {
+	FString RelativePath;
+	return !FindArchive(Directory, RelativePath).IsValid() && LowerLevel->DeleteDirectory(Directory);
+}
+
+FFileStatData FHeaderDumpArchivePlatformFile::GetStatData(const TCHAR* FilenameOrDirectory) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(FilenameOrDirectory, RelativePath)) {
+		if (const FHeaderDumpArchiveEntry* Entry = Archive->FindFile(RelativePath)) {
+			return FFileStatData(Archive->GetTimeStamp(), Archive->GetTimeStamp(), Archive->GetTimeStamp(), Entry->Size, false, true);
+		}
+		if (Archive->DirectoryExists(RelativePath)) {
+			return FFileStatData(Archive->GetTimeStamp(), Archive->GetTimeStamp(), Archive->GetTimeStamp(), -1, true, true);
+		}
+		return FFileStatData();
+	}
+	return LowerLevel->GetStatData(FilenameOrDirectory);
+}
+
+bool FHeaderDumpArchivePlatformFile::IterateDirectory(const TCHAR* Directory, FDirectoryVisitor& Visitor) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(Directory, RelativePath)) {
+		const FString DirectoryPath = Directory;
+		return Archive->IterateDirectory(RelativePath, [&](const FHeaderDumpArchiveDirectoryEntry& DirectoryEntry) {
+			return Visitor.Visit(*(DirectoryPath / DirectoryEntry.Name), DirectoryEntry.bIsDirectory);
+		});
+	}
+	return LowerLevel->IterateDirectory(Directory, Visitor);
+}
+
+bool FHeaderDumpArchivePlatformFile::IterateDirectoryStat(const TCHAR* Directory, FDirectoryStatVisitor& Visitor) {
+	FString RelativePath;
+	if (const TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Archive = FindArchive(Directory, RelativePath)) {
+		const FString DirectoryPath = Directory;
+		return Archive->IterateDirectory(RelativePath, [&](const FHeaderDumpArchiveDirectoryEntry& DirectoryEntry) {
+			const FString EntryPath = DirectoryPath / DirectoryEntry.Name;
+			return Visitor.Visit(*EntryPath, GetStatData(*EntryPath));
+		});
+	}
+	return LowerLevel->IterateDirectoryStat(Directory, Visitor);
+}
+
+FString FHeaderDumpArchivePlatformFile::ConvertToAbsolutePathForExternalAppForRead(const TCHAR* Filename) {
+	return LowerLevel->ConvertToAbsolutePathForExternalAppForRead(Filename);
+}
+
+FString FHeaderDumpArchivePlatformFile::ConvertToAbsolutePathForExternalAppForWrite(const TCHAR* Filename) {
+	return LowerLevel->ConvertToAbsolutePathForExternalAppForWrite(Filename);
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/ThreadSafeCounter.h"
+
+/** Single file stored inside of the header dump archive */
+struct FHeaderDumpArchiveEntry {
+	/** Offset of the file data inside of the archive, or of the local file header for the zip entries */
+	int64 Offset = 0;
+	int64 CompressedSize = 0;
+	int64 Size = 0;
+	/** File data is deflated, otherwise it is stored as is */
+	bool bIsDeflated = false;
+	/** Offset points to the local file header of the zip entry, which needs to be read to find the file data */
+	bool bHasLocalHeader = false;
+};
+
+/** File or directory directly inside of the archive directory */
+struct FHeaderDumpArchiveDirectoryEntry {
+	FString Name;
+	bool bIsDirectory;
+};
+
+/**
+ * Zip or tar archive containing the header dump, indexed once so its files can be read in any order without extracting them
+ * Gzip compressed tar archives cannot be read out of order, so they are inflated into memory as a whole when opened.
+ * When all of the archive contents are inside of the single directory, that directory is treated as the root of the archive
+ */
+class FHeaderDumpArchive : public TSharedFromThis<FHeaderDumpArchive, ESPMode::ThreadSafe> {
+public:
+	/** Checks whenever the path has one of the archive extensions, including the ones that are recognized but not supported */
+	static bool IsArchiveFilename(const FString& Filename);
+
+	/** Reads the index of the archive through the given platform file. Returns NULL along with the error message when it cannot be read or its format is not supported */
+	static TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> Open(IPlatformFile& InArchivePlatformFile, const FString& InArchiveFilename, FString& OutErrorMessage);
+
+	const FHeaderDumpArchiveEntry* FindFile(const FString& RelativeFilename) const;
+	bool DirectoryExists(const FString& RelativeDirectory) const;
+
+	/** Visits the files and directories directly inside of the directory, returns false when the directory does not exist or the visitor has stopped the iteration */
+	bool IterateDirectory(const FString& RelativeDirectory, TFunctionRef<bool(const FHeaderDumpArchiveDirectoryEntry&)> Visitor) const;
+
+	/** Opens the file for reading. Deflated files are inflated into memory in one go, stored files are read from the archive directly. Thread safe */
+	IFileHandle* OpenFile(const FString& RelativeFilename);
+
+	FDateTime GetTimeStamp() const { return TimeStamp; }
+	int32 Num() const { return Files.Num(); }
+private:
+	friend class FHeaderDumpArchiveFileHandle;
+
+	FHeaderDumpArchive(IPlatformFile& InArchivePlatformFile, const FString& InArchiveFilename);
+
+	bool ReadZipIndex(TArray<TPair<FString, FHeaderDumpArchiveEntry>>& OutFiles, TArray<FString>& OutDirectories, FString& OutErrorMessage);
+	bool ReadTarIndex(int64 ArchiveSize, TFunctionRef<bool(int64, uint8*, int64)> ReadArchiveData, TArray<TPair<FString, FHeaderDumpArchiveEntry>>& OutFiles, TArray<FString>& OutDirectories, FString& OutErrorMessage);
+	bool InflateGzipArchive(FString& OutErrorMessage);
+	void AddEntries(const TArray<TPair<FString, FHeaderDumpArchiveEntry>>& FoundFiles, const TArray<FString>& FoundDirectories);
+	void AddDirectoryEntry(const FString& Path, bool bIsDirectory);
+
+	/** Archive file handles are reused between the opened files, so reading the thousands of files from the archive does not open it for each of them */
+	TUniquePtr<IFileHandle> AcquireArchiveHandle();
+	void ReleaseArchiveHandle(TUniquePtr<IFileHandle> ArchiveHandle);
+
+	IPlatformFile& ArchivePlatformFile;
+	FString ArchiveFilename;
+	FDateTime TimeStamp;
+	TMap<FString, FHeaderDumpArchiveEntry> Files;
+	TMap<FString, TArray<FHeaderDumpArchiveDirectoryEntry>> Directories;
+	/** Contents of the inflated tar archive when it has been compressed with gzip, offsets of the files point into it */
+	TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> InflatedContents;
+	TArray<TUniquePtr<IFileHandle>> ArchiveHandles;
+	FCriticalSection ArchiveHandlesLock;
+};
+
+/**
+ * Platform file layer serving the mounted header dump archives as the read-only directories at the paths of the archives themselves,
+ * so the header dump is walked and read the same way whenever it has been extracted or not. Everything else goes to the lower level platform file
+ */
+class FHeaderDumpArchivePlatformFile : public IPlatformFile {
+public:
+	/** Mounts the archive, installing the layer on top of the platform file chain the first time. Archives stay mounted until the exit */
+	static bool MountArchive(const FString& ArchiveFilename, FString& OutErrorMessage);
+
+	/** Checks whenever the path is the mount point of one of the archives */
+	static bool IsMountedArchive(const FString& Path);
+
+	//Begin IPlatformFile interface
+	virtual bool Initialize(IPlatformFile* Inner, const TCHAR* CmdLine) override;
+	virtual IPlatformFile* GetLowerLevel() override { return LowerLevel; }
+	virtual void SetLowerLevel(IPlatformFile* NewLowerLevel) override { LowerLevel = NewLowerLevel; }
+	virtual const TCHAR* GetName() const override { return TEXT("HeaderDumpArchive"); }
+	virtual bool FileExists(const TCHAR* Filename) override;
+	virtual int64 FileSize(const TCHAR* Filename) override;
+	virtual bool DeleteFile(const TCHAR* Filename) override;
+	virtual bool IsReadOnly(const TCHAR* Filename) override;
+	virtual bool MoveFile(const TCHAR* To, const TCHAR* From) override;
+	virtual bool SetReadOnly(const TCHAR* Filename, bool bNewReadOnlyValue) override;
+	virtual FDateTime GetTimeStamp(const TCHAR* Filename) override;
+	virtual void SetTimeStamp(const TCHAR* Filename, FDateTime DateTime) override;
+	virtual FDateTime GetAccessTimeStamp(const TCHAR* Filename) override;
+	virtual FString GetFilenameOnDisk(const TCHAR* Filename) override;
+	virtual IFileHandle* OpenRead(const TCHAR* Filename, bool bAllowWrite = false) override;
+	virtual IFileHandle* OpenWrite(const TCHAR* Filename, bool bAppend = false, bool bAllowRead = false) override;
+	virtual bool DirectoryExists(const TCHAR* Directory) override;
+	virtual bool CreateDirectory(const TCHAR* Directory) override;
+	virtual bool DeleteDirectory(const TCHAR* Directory) override;
+	virtual FFileStatData GetStatData(const TCHAR* FilenameOrDirectory) override;
+	virtual bool IterateDirectory(const TCHAR* Directory, FDirectoryVisitor& Visitor) override;
+	virtual bool IterateDirectoryStat(const TCHAR* Directory, FDirectoryStatVisitor& Visitor) override;
+	virtual FString ConvertToAbsolutePathForExternalAppForRead(const TCHAR* Filename) override;
+	virtual FString ConvertToAbsolutePathForExternalAppForWrite(const TCHAR* Filename) override;
+	//End IPlatformFile interface
+private:
+	FHeaderDumpArchivePlatformFile();
+
+	/** Finds the archive mounted at the path or at one of its parent directories, along with the path relative to the archive root */
+	TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe> FindArchive(const TCHAR* Path, FString& OutRelativePath) const;
+
+	IPlatformFile* LowerLevel;
+	/** Mounted archives keyed by their full path, resolved once when they are mounted */
+	TMap<FString, TSharedPtr<FHeaderDumpArchive, ESPMode::ThreadSafe>> MountedArchives;
+	/** File names of the mounted archives, paths not containing any of them are not inside of the archives */
+	TArray<FString> MountedArchiveNames;
+	FThreadSafeCounter NumMountedArchives;
+	/** Archives are only mounted while parsing the arguments, so the lookups made by the workers never wait for each other */
+	mutable FRWLock MountedArchivesLock;
+};
@@ -0,0 +1,489 @@
+#include "HeaderFileRewriter.h"
+#include "ProjectGenerator.h"
+#include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
+
+const ANSICHAR FHeaderFileRewriter::CrossModuleIncludePrefix[] = "//CROSS-MODULE INCLUDE V2: ";
+
+//Follows the block comments and the #if 0 blocks line by line, so only the includes that are actually compiled are used as the insertion point
+class FActiveIncludeLineTracker {
+public:
+	/** Returns true when the line is the include directive outside of any block comment or disabled block */
+	bool IsActiveIncludeLine(const uint8* LineStart, const uint8* LineEnd) {
+		const bool bStartsInsideBlockComment = bInsideBlockComment;
+		for (const uint8* Character = LineStart; Character + 1 < LineEnd; Character++) {
+			if (!bInsideBlockComment && Character[0] == '/' && Character[1] == '/') {
+				break;
+			}
+			if (!bInsideBlockComment && Character[0] == '/' && Character[1] == '*') {
+				bInsideBlockComment = true;
+				Character++;
+			} else if (bInsideBlockComment && Character[0] == '*' && Character[1] == '/') {
+				bInsideBlockComment = false;
+				Character++;
+			}
+		}
+		if (bStartsInsideBlockComment) {
+			return false;
+		}
+
+		//Directives can be indented, and can have whitespace between the hash and their name
+		const uint8* DirectiveName = SkipWhitespace(LineStart, LineEnd);
+		if (DirectiveName == LineEnd || *DirectiveName != '#') {
+			return false;
+		}
+		DirectiveName = SkipWhitespace(DirectiveName + 1, LineEnd);
+
+		if (DisabledBlockDepth > 0) {
+			//Nested conditionals are only counted, the else branch of the outermost disabled block is compiled again
+			if (IsDirective(DirectiveName, LineEnd, "if")) {
+				DisabledBlockDepth++;
+			} else if (IsDirective(DirectiveName, LineEnd, "endif")) {
+				DisabledBlockDepth--;
+			} else if (DisabledBlockDepth == 1 && (IsDirective(DirectiveName, LineEnd, "else") || IsDirective(DirectiveName, LineEnd, "elif"))) {
+				DisabledBlockDepth = 0;
+			}
+			return false;
+		}
+		if (IsDirective(DirectiveName, LineEnd, "if ") || IsDirective(DirectiveName, LineEnd, "if\t")) {
+			const uint8* Condition = SkipWhitespace(DirectiveName + 3, LineEnd);
+			if (Condition < LineEnd && *Condition == '0' && (Condition + 1 == LineEnd || !FChar::IsAlnum((TCHAR) Condition[1]))) {
+				DisabledBlockDepth = 1;
+			}
+			return false;
+		}
+		return IsDirective(DirectiveName, LineEnd, "include");
+	}
+private:
+	static const uint8* SkipWhitespace(const uint8* Start, const uint8* End) {
+		while (Start < End && (*Start == ' ' || *Start == '\t')) {
+			Start++;
+		}
+		return Start;
+	}
+
+	static bool IsDirective(const uint8* DirectiveName, const uint8* LineEnd, const ANSICHAR* ExpectedName) {
+		const int32 NameLength = FCStringAnsi::Strlen(ExpectedName);
+		return LineEnd - DirectiveName >= NameLength && FMemory::Memcmp(DirectiveName, ExpectedName, NameLength) == 0;
+	}
+
+	bool bInsideBlockComment = false;
+	int32 DisabledBlockDepth = 0;
+};
+
+//Length of the UTF-8 byte order mark at the start of the file, which the inserted includes have to go after
+static int64 GetByteOrderMarkLength(const uint8* Contents, int64 ContentsSize) {
+	return ContentsSize >= 3 && Contents[0] == 0xEF && Contents[1] == 0xBB && Contents[2] == 0xBF ? 3 : 0;
+}
+
+FHeaderFileRewriter::FHeaderFileRewriter(ICrossModuleIncludeResolver& InIncludeResolver) : IncludeResolver(InIncludeResolver) {
+}
+
+bool FHeaderFileRewriter::LoadFileContents(const FString& Filename, TArray<uint8>& OutFileContents) {
+	if (!FFileHelper::LoadFileToArray(OutFileContents, *Filename)) {
+		return false;
+	}
+	ConvertUTF16ContentsToUTF8(OutFileContents);
+	return true;
+}
+
+bool FHeaderFileRewriter::ConvertUTF16ContentsToUTF8(TArray<uint8>& FileContents) {
+	//Marker scanning works on the 8-bit characters, so UTF-16 files need to be converted first. UE4SS does not normally emit them
+	const bool bIsLittleEndianUTF16 = FileContents.Num() >= 2 && FileContents[0] == 0xFF && FileContents[1] == 0xFE;
+	const bool bIsBigEndianUTF16 = FileContents.Num() >= 2 && FileContents[0] == 0xFE && FileContents[1] == 0xFF;
+	if (!bIsLittleEndianUTF16 && !bIsBigEndianUTF16) {
+		return false;
+	}
+
+	FString FileContentsString;
+	FFileHelper::BufferToString(FileContentsString, FileContents.GetData(), FileContents.Num());
+
+	const FTCHARToUTF8 FileContentsUTF8(*FileContentsString);
+	FileContents.Reset(FileContentsUTF8.Length());
+	FileContents.Append((const uint8*) FileContentsUTF8.Get(), FileContentsUTF8.Length());
+	return true;
+}
+
+void FHeaderFileRewriter::FindIncludeMarkers(const FString& HeaderFileName, const TArray<uint8>& FileContents, TArray<FHeaderIncludeMarker>& OutMarkers) {
+	const uint8* ContentsStart = FileContents.GetData();
+	const uint8* ContentsEnd = ContentsStart + FileContents.Num();
+
+	//Skip the UTF-8 byte order mark so the marker on the first line is still recognized
+	const uint8* LineStart = ContentsStart;
+	if (FileContents.Num() >= 3 && LineStart[0] == 0xEF && LineStart[1] == 0xBB && LineStart[2] == 0xBF) {
+		LineStart += 3;
+	}
+
+	while (LineStart < ContentsEnd) {
+		const uint8* LineTerminator = (const uint8*) memchr(LineStart, '\n', ContentsEnd - LineStart);
+		const uint8* NextLineStart = LineTerminator != NULL ? LineTerminator + 1 : ContentsEnd;
+		const uint8* LineEnd = LineTerminator != NULL ? LineTerminator : ContentsEnd;
+
+		//Windows line endings have the carriage return before the new line character, which is not a part of the line itself
+		if (LineEnd > LineStart && LineEnd[-1] == '\r') {
+			LineEnd--;
+		}
+		ParseIncludeMarkerLine(HeaderFileName, LineStart, LineEnd - LineStart, LineStart - ContentsStart, OutMarkers);
+		LineStart = NextLineStart;
+	}
+}
+
+void FHeaderFileRewriter::ParseIncludeMarkerLine(const FString& HeaderFileName, const uint8* LineStart, int64 LineLength, int64 LineOffset, TArray<FHeaderIncludeMarker>& OutMarkers) {
+	const int32 PrefixLength = UE_ARRAY_COUNT(CrossModuleIncludePrefix) - 1;
+
+	//Only the lines starting with the marker are ever converted into the strings, matching is case insensitive like FString::StartsWith
+	if (LineLength < PrefixLength || LineStart[0] != '/' || FCStringAnsi::Strnicmp((const ANSICHAR*) LineStart, CrossModuleIncludePrefix, PrefixLength) != 0) {
+		return;
+	}
+	const FUTF8ToTCHAR HeaderStringConverter((const ANSICHAR*) LineStart, (int32) LineLength);
+	const FString HeaderString(HeaderStringConverter.Length(), HeaderStringConverter.Get());
+	const FString IncludeData = HeaderString.Mid(PrefixLength);
+
+	FString IncludeModuleName;
+	FString IncludeObjectName;
+	FParse::Value(*IncludeData, TEXT("ModuleName="), IncludeModuleName);
+	FParse::Value(*IncludeData, TEXT("ObjectName="), IncludeObjectName);
+
+	if (IncludeModuleName.Len() == 0 || IncludeObjectName.Len() == 0) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Malformed cross module include string encoutered processing %s: %s"), *HeaderFileName, *HeaderString);
+		return;
+	}
+	FString FallbackHeaderName = IncludeObjectName;
+	FParse::Value(*IncludeData, TEXT("FallbackName="), FallbackHeaderName);
+
+	FHeaderIncludeMarker& IncludeMarker = OutMarkers.AddDefaulted_GetRef();
+	IncludeMarker.LineOffset = LineOffset;
+	IncludeMarker.LineLength = LineLength;
+	IncludeMarker.IncludeKey = FCrossModuleIncludeKey{IncludeModuleName, IncludeObjectName, FallbackHeaderName};
+}
+
+bool FHeaderFileRewriter::ScanFileInChunks(const FString& Filename, int64 ChunkSize, FHeaderFileScan& OutFileScan) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenRead(*Filename));
+	if (!FileHandle.IsValid()) {
+		return false;
+	}
+	OutFileScan.FileSize = FileHandle->Size();
+
+	FMD5 SourceHash;
+	bool bFoundFirstLine = false;
+	bool bFoundInsertionOffset = false;
+	FActiveIncludeLineTracker IncludeLineTracker;
+
+	//Buffer holds the unfinished line carried over from the previous chunk followed by the current chunk, and starts at the given offset of the file
+	TArray<uint8> ChunkBuffer;
+	int64 BufferOffset = 0;
+	int64 RemainingBytes = OutFileScan.FileSize;
+
+	while (RemainingBytes > 0) {
+		const int32 CarriedOverBytes = ChunkBuffer.Num();
+		const int64 BytesToRead = FMath::Min(ChunkSize, RemainingBytes);
+		ChunkBuffer.SetNumUninitialized(CarriedOverBytes + (int32) BytesToRead, false);
+
+		if (!FileHandle->Read(ChunkBuffer.GetData() + CarriedOverBytes, BytesToRead)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Failed to read file %s"), *Filename);
+			return false;
+		}
+		SourceHash.Update(ChunkBuffer.GetData() + CarriedOverBytes, BytesToRead);
+		RemainingBytes -= BytesToRead;
+
+		const uint8* BufferStart = ChunkBuffer.GetData();
+		const uint8* BufferEnd = BufferStart + ChunkBuffer.Num();
+		const uint8* LineStart = BufferStart;
+
+		//UTF-16 files have to be converted as a whole, and the UTF-8 byte order mark is skipped like when the file is scanned in memory
+		if (BufferOffset == 0 && CarriedOverBytes == 0) {
+			if (ChunkBuffer.Num() >= 2 && ((LineStart[0] == 0xFF && LineStart[1] == 0xFE) || (LineStart[0] == 0xFE && LineStart[1] == 0xFF))) {
+				return false;
+			}
+			LineStart += GetByteOrderMarkLength(LineStart, ChunkBuffer.Num());
+			OutFileScan.IncludeInsertionOffset = LineStart - BufferStart;
+		}
+
+		while (LineStart < BufferEnd) {
+			const uint8* LineTerminator = (const uint8*) memchr(LineStart, '\n', BufferEnd - LineStart);
+
+			//Unfinished line is scanned once the rest of it has been read, unless it is the last line of the file
+			if (LineTerminator == NULL && RemainingBytes > 0) {
+				break;
+			}
+			const uint8* NextLineStart = LineTerminator != NULL ? LineTerminator + 1 : BufferEnd;
+			const uint8* LineEnd = LineTerminator != NULL ? LineTerminator : BufferEnd;
+
+			if (LineEnd > LineStart && LineEnd[-1] == '\r') {
+				LineEnd--;
+			}
+			if (!bFoundFirstLine) {
+				OutFileScan.bUsesCarriageReturn = LineTerminator != NULL && LineEnd != LineTerminator;
+				bFoundFirstLine = true;
+			}
+			const int64 LineLength = LineEnd - LineStart;
+			ParseIncludeMarkerLine(Filename, LineStart, LineLength, BufferOffset + (LineStart - BufferStart), OutFileScan.IncludeMarkers);
+
+			if (!bFoundInsertionOffset && IncludeLineTracker.IsActiveIncludeLine(LineStart, LineEnd)) {
+				OutFileScan.IncludeInsertionOffset = BufferOffset + (NextLineStart - BufferStart);
+				OutFileScan.bIncludeInsertionAfterUnterminatedLine = LineTerminator == NULL;
+				bFoundInsertionOffset = true;
+			}
+			LineStart = NextLineStart;
+		}
+
+		const int32 ConsumedBytes = (int32) (LineStart - BufferStart);
+		ChunkBuffer.RemoveAt(0, ConsumedBytes, false);
+		BufferOffset += ConsumedBytes;
+	}
+
+	FMD5Hash ResultHash;
+	ResultHash.Set(SourceHash);
+	OutFileScan.SourceHash = LexToString(ResultHash);
+	return true;
+}
+
+void FHeaderFileRewriter::ResolveIncludeMarkers(const FString& HeaderFileName, const TArray<uint8>& FileContents, TArray<FHeaderLineReplacement>& OutReplacements, const TMap<FCrossModuleIncludeKey, FString>* ForwardDeclarations) const {
+	TArray<FHeaderIncludeMarker> IncludeMarkers;
+	FindIncludeMarkers(HeaderFileName, FileContents, IncludeMarkers);
+	ResolveIncludeMarkers(HeaderFileName, IncludeMarkers, OutReplacements, ForwardDeclarations);
+}
+
+void FHeaderFileRewriter::ResolveIncludeMarkers(const FString& HeaderFileName, const TArray<FHeaderIncludeMarker>& IncludeMarkers, TArray<FHeaderLineReplacement>& OutReplacements, const TMap<FCrossModuleIncludeKey, FString>* ForwardDeclarations) const {
+	for (const FHeaderIncludeMarker& IncludeMarker : IncludeMarkers) {
+		if (const FString* ForwardDeclaration = ForwardDeclarations != NULL ? ForwardDeclarations->Find(IncludeMarker.IncludeKey) : NULL) {
+			FHeaderLineReplacement& LineReplacement = OutReplacements.AddDefaulted_GetRef();
+			LineReplacement.LineOffset = IncludeMarker.LineOffset;
+			LineReplacement.LineLength = IncludeMarker.LineLength;
+			LineReplacement.NewLine = *ForwardDeclaration;
+			continue;
+		}
+		
+		FString ResolvedIncludeString;
+		if (IncludeResolver.ResolveInclude(HeaderFileName, IncludeMarker.IncludeKey, ResolvedIncludeString)) {
+			FHeaderLineReplacement& LineReplacement = OutReplacements.AddDefaulted_GetRef();
+			LineReplacement.LineOffset = IncludeMarker.LineOffset;
+			LineReplacement.LineLength = IncludeMarker.LineLength;
+			LineReplacement.NewLine = MoveTemp(ResolvedIncludeString);
+			LineReplacement.ModuleName = IncludeMarker.IncludeKey.ModuleName;
+		}
+	}
+}
+
+static bool IsIdentifierCharacter(TCHAR Character) {
+	return FChar::IsAlnum(Character) || Character == TEXT('_');
+}
+
+bool FHeaderFileRewriter::FindForwardDeclarableClass(const FString& FileContents, const FString& ObjectName, FString& OutClassName) {
+	//Templates which only need the declaration of the class they are instantiated with
+	static const TCHAR* ForwardDeclarableTemplates[] = {TEXT("TSubclassOf"), TEXT("TWeakObjectPtr"), TEXT("TSoftObjectPtr"), TEXT("TSoftClassPtr"), TEXT("TLazyObjectPtr")};
+	
+	//Objects deriving from AActor use the A prefix, the rest of the classes use U
+	static const TCHAR* ClassPrefixes[] = {TEXT("U"), TEXT("A")};
+
+	for (const TCHAR* ClassPrefix : ClassPrefixes) {
+		const FString ClassName = ClassPrefix + ObjectName;
+		int32 NumUsages = 0;
+		int32 SearchStart = 0;
+		int32 UsageStart;
+
+		while ((UsageStart = FileContents.Find(ClassName, ESearchCase::CaseSensitive, ESearchDir::FromStart, SearchStart)) != INDEX_NONE) {
+			const int32 UsageEnd = UsageStart + ClassName.Len();
+			SearchStart = UsageEnd;
+
+			//Only the whole identifiers count, UFooBar is not an usage of UFoo
+			if ((UsageStart > 0 && IsIdentifierCharacter(FileContents[UsageStart - 1])) || (UsageEnd < FileContents.Len() && IsIdentifierCharacter(FileContents[UsageEnd]))) {
+				continue;
+			}
+
+			int32 NextCharacterIndex = UsageEnd;
+			while (NextCharacterIndex < FileContents.Len() && FChar::IsWhitespace(FileContents[NextCharacterIndex])) {
+				NextCharacterIndex++;
+			}
+			const TCHAR NextCharacter = NextCharacterIndex < FileContents.Len() ? FileContents[NextCharacterIndex] : TEXT('\0');
+
+			int32 PreviousCharacterIndex = UsageStart - 1;
+			while (PreviousCharacterIndex >= 0 && FChar::IsWhitespace(FileContents[PreviousCharacterIndex])) {
+				PreviousCharacterIndex--;
+			}
+			int32 PreviousIdentifierStart = PreviousCharacterIndex + (PreviousCharacterIndex >= 0 && FileContents[PreviousCharacterIndex] == TEXT('<') ? 0 : 1);
+			while (PreviousIdentifierStart > 0 && IsIdentifierCharacter(FileContents[PreviousIdentifierStart - 1])) {
+				PreviousIdentifierStart--;
+			}
+
+			//Pointers and references, or the existing forward declaration
+			bool bCanBeForwardDeclared = NextCharacter == TEXT('*') || NextCharacter == TEXT('&');
+			if (!bCanBeForwardDeclared && NextCharacter == TEXT(';')) {
+				bCanBeForwardDeclared = FileContents.Mid(PreviousIdentifierStart, PreviousCharacterIndex + 1 - PreviousIdentifierStart) == TEXT("class");
+			}
+			if (!bCanBeForwardDeclared && NextCharacter == TEXT('>') && PreviousCharacterIndex >= 0 && FileContents[PreviousCharacterIndex] == TEXT('<')) {
+				const FString TemplateName = FileContents.Mid(PreviousIdentifierStart, PreviousCharacterIndex - PreviousIdentifierStart);
+				for (const TCHAR* ForwardDeclarableTemplate : ForwardDeclarableTemplates) {
+					bCanBeForwardDeclared |= TemplateName == ForwardDeclarableTemplate;
+				}
+			}
+			
+			if (!bCanBeForwardDeclared) {
+				return false;
+			}
+			NumUsages++;
+		}
+
+		if (NumUsages) {
+			OutClassName = ClassName;
+			return true;
+		}
+	}
+	return false;
+}
+
+int64 FHeaderFileRewriter::FindIncludeInsertionOffset(const TArray<uint8>& FileContents, bool& bOutAfterUnterminatedLine) {
+	bOutAfterUnterminatedLine = false;
+	const uint8* ContentsStart = FileContents.GetData();
+	const uint8* ContentsEnd = ContentsStart + FileContents.Num();
+
+	//Files without any includes get them right after the byte order mark, so it stays at the start of the file
+	const uint8* LineStart = ContentsStart + GetByteOrderMarkLength(ContentsStart, FileContents.Num());
+	const int64 FallbackOffset = LineStart - ContentsStart;
+	FActiveIncludeLineTracker IncludeLineTracker;
+
+	while (LineStart < ContentsEnd) {
+		const uint8* LineTerminator = (const uint8*) memchr(LineStart, '\n', ContentsEnd - LineStart);
+		const uint8* NextLineStart = LineTerminator != NULL ? LineTerminator + 1 : ContentsEnd;
+		const uint8* LineEnd = LineTerminator != NULL ? LineTerminator : ContentsEnd;
+
+		if (IncludeLineTracker.IsActiveIncludeLine(LineStart, LineEnd)) {
+			bOutAfterUnterminatedLine = LineTerminator == NULL;
+			return NextLineStart - ContentsStart;
+		}
+		LineStart = NextLineStart;
+	}
+	return FallbackOffset;
+}
+
+//Writes the replaced lines into the file, copying the untouched spans between them from the source with the given function
+//Existing file with the same contents is left untouched, so its timestamp does not change and the builds depending on it stay up to date
+static bool WriteReplacedLines(const FString& Filename, int64 SourceSize, bool bUsesCarriageReturn, const TArray<FHeaderLineReplacement>& Replacements, TFunctionRef<bool(int64, int64, TFunctionRef<void(const uint8*, int64)>)> CopySourceSpan, FString& OutOutputHash, int64& OutBytesWritten, bool& bOutUnchanged) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	OutBytesWritten = 0;
+	bOutUnchanged = false;
+
+	//Inserted lines use the same line terminator as the rest of the file
+	const ANSICHAR* InsertedLineTerminator = bUsesCarriageReturn ? "\r\n" : "\n";
+	const int64 InsertedLineTerminatorLength = FCStringAnsi::Strlen(InsertedLineTerminator);
+
+	auto EmitRewrittenContents = [&](TFunctionRef<void(const uint8*, int64)> EmitData) {
+		bool bReadSucceeded = true;
+		int64 CurrentOffset = 0;
+		for (const FHeaderLineReplacement& Replacement : Replacements) {
+			bReadSucceeded &= CopySourceSpan(CurrentOffset, Replacement.LineOffset - CurrentOffset, EmitData);
+
+			//Otherwise the inserted line would be glued to the end of the last line of the file
+			if (Replacement.bTerminatePreviousLine) {
+				EmitData((const uint8*) InsertedLineTerminator, InsertedLineTerminatorLength);
+			}
+			const FTCHARToUTF8 NewLineUTF8(*Replacement.NewLine);
+			EmitData((const uint8*) NewLineUTF8.Get(), NewLineUTF8.Length());
+			if (Replacement.LineLength == 0) {
+				EmitData((const uint8*) InsertedLineTerminator, InsertedLineTerminatorLength);
+			}
+			CurrentOffset = Replacement.LineOffset + Replacement.LineLength;
+		}
+		bReadSucceeded &= CopySourceSpan(CurrentOffset, SourceSize - CurrentOffset, EmitData);
+		return bReadSucceeded;
+	};
+
+	const int64 ExistingFileSize = PlatformFile.FileSize(*Filename);
+	if (ExistingFileSize >= 0) {
+		//Size of the rewritten file is known without producing it, so the contents only need to be compared when it matches
+		int64 RewrittenFileSize = SourceSize;
+		for (const FHeaderLineReplacement& Replacement : Replacements) {
+			RewrittenFileSize += FTCHARToUTF8(*Replacement.NewLine).Length() - Replacement.LineLength;
+			if (Replacement.LineLength == 0) {
+				RewrittenFileSize += InsertedLineTerminatorLength;
+			}
+			if (Replacement.bTerminatePreviousLine) {
+				RewrittenFileSize += InsertedLineTerminatorLength;
+			}
+		}
+
+		if (RewrittenFileSize == ExistingFileSize) {
+			FMD5 RewrittenHash;
+			const bool bReadSucceeded = EmitRewrittenContents([&](const uint8* Data, int64 Size) {
+				RewrittenHash.Update(Data, Size);
+			});
+			FMD5Hash ResultHash;
+			ResultHash.Set(RewrittenHash);
+			
+			if (bReadSucceeded && LexToString(FMD5Hash::HashFile(*Filename)) == LexToString(ResultHash)) {
+				OutOutputHash = LexToString(ResultHash);
+				bOutUnchanged = true;
+				return true;
+			}
+		}
+		//Target can still be linked to the source file by one of the previous runs, so it is replaced rather than written through
+		PlatformFile.DeleteFile(*Filename);
+	}
+
+	TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*Filename));
+	if (!FileHandle.IsValid()) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Failed to open file %s for writing"), *Filename);
+		return false;
+	}
+
+	FMD5 OutputHash;
+	bool bWriteFailed = false;
+
+	//Write failures are only recorded by the callback, so they are not lost to the evaluation order of the read result
+	const bool bReadSucceeded = EmitRewrittenContents([&](const uint8* Data, int64 Size) {
+		if (Size > 0) {
+			OutputHash.Update(Data, Size);
+			OutBytesWritten += Size;
+			bWriteFailed |= !FileHandle->Write(Data, Size);
+		}
+	});
+
+	FMD5Hash ResultHash;
+	ResultHash.Set(OutputHash);
+	OutOutputHash = LexToString(ResultHash);
+
+	if (!bReadSucceeded || bWriteFailed) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Failed to write file %s"), *Filename);
+	}
+	return bReadSucceeded && !bWriteFailed;
+}
+
+bool FHeaderFileRewriter::WriteRewrittenFile(const FString& Filename, const TArray<uint8>& FileContents, const TArray<FHeaderLineReplacement>& Replacements, FString& OutOutputHash, int64& OutBytesWritten, bool& bOutUnchanged) {
+	const uint8* FirstLineTerminator = (const uint8*) memchr(FileContents.GetData(), '\n', FileContents.Num());
+	const bool bUsesCarriageReturn = FirstLineTerminator != NULL && FirstLineTerminator > FileContents.GetData() && FirstLineTerminator[-1] == '\r';
+
+	//Untouched spans between the replaced lines go straight from the source buffer into the file
+	return WriteReplacedLines(Filename, FileContents.Num(), bUsesCarriageReturn, Replacements, [&](int64 Offset, int64 Size, TFunctionRef<void(const uint8*, int64)> WriteData) {
+		WriteData(FileContents.GetData() + Offset, Size);
+		return true;
+	}, OutOutputHash, OutBytesWritten, bOutUnchanged);
+}
+
+bool FHeaderFileRewriter::WriteRewrittenFileInChunks(const FString& Filename, const FString& SourceFilename, const FHeaderFileScan& SourceFileScan, int64 ChunkSize, const TArray<FHeaderLineReplacement>& Replacements, FString& OutOutputHash, int64& OutBytesWritten, bool& bOutUnchanged) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IFileHandle> SourceFileHandle(PlatformFile.OpenRead(*SourceFilename));
+	if (!SourceFileHandle.IsValid()) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Failed to open file %s for reading"), *SourceFilename);
+		return false;
+	}
+
+	//Spans are copied in the file order, so the source is only ever read sequentially through the single chunk sized buffer
+	TArray<uint8> ChunkBuffer;
+	ChunkBuffer.SetNumUninitialized((int32) FMath::Min(ChunkSize, SourceFileScan.FileSize));
+
+	return WriteReplacedLines(Filename, SourceFileScan.FileSize, SourceFileScan.bUsesCarriageReturn, Replacements, [&](int64 Offset, int64 Size, TFunctionRef<void(const uint8*, int64)> WriteData) {
+		if (Size > 0 && !SourceFileHandle->Seek(Offset)) {
+			return false;
+		}
+		while (Size > 0) {
+			const int64 BytesToRead = FMath::Min(Size, (int64) ChunkBuffer.Num());
+			if (!SourceFileHandle->Read(ChunkBuffer.GetData(), BytesToRead)) {
+				return false;
+			}
+			WriteData(ChunkBuffer.GetData(), BytesToRead);
+			Size -= BytesToRead;
+		}
+		return true;
+	}, OutOutputHash, OutBytesWritten, bOutUnchanged);
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ICrossModuleIncludeResolver.h"
+
+/** Replacement of the single line inside of the header file */
+struct FHeaderLineReplacement {
+	/** Byte offset of the first character of the line */
+	int64 LineOffset;
+	/** Length of the line in bytes, not including the line terminator. New line is inserted before the line at the offset when it is zero */
+	int64 LineLength;
+	/** New contents of the line */
+	FString NewLine;
+	/** Module the included object belongs to, empty when the new line does not include anything */
+	FString ModuleName;
+	/** Whenever the inserted line follows the last line of the file that has no line terminator, so one has to be written before it */
+	bool bTerminatePreviousLine = false;
+};
+
+/** CROSS-MODULE INCLUDE marker found inside of the header file */
+struct FHeaderIncludeMarker {
+	/** Byte offset of the first character of the marker line */
+	int64 LineOffset;
+	/** Length of the marker line in bytes, not including the line terminator */
+	int64 LineLength;
+	/** Object referenced by the marker */
+	FCrossModuleIncludeKey IncludeKey;
+};
+
+/** Include markers and the other details of the file collected by reading it in the fixed size chunks, without holding it in memory as a whole */
+struct FHeaderFileScan {
+	TArray<FHeaderIncludeMarker> IncludeMarkers;
+	/** Byte offset of the line following the first include of the file, or the one following the byte order mark when it does not have any */
+	int64 IncludeInsertionOffset = 0;
+	/** Whenever the include insertion offset is at the end of the last line of the file, which has no line terminator */
+	bool bIncludeInsertionAfterUnterminatedLine = false;
+	/** Whenever the first line of the file is terminated by the carriage return and the new line */
+	bool bUsesCarriageReturn = false;
+	int64 FileSize = 0;
+	FString SourceHash;
+};
+
+/**
+ * Rewrites CROSS-MODULE INCLUDE markers inside of the header and source files into the includes
+ * Operates on the raw UTF-8 file contents, so only the marker lines are ever converted into strings,
+ * and everything else is written into the resulting file byte for byte
+ */
+class FHeaderFileRewriter {
+public:
+	explicit FHeaderFileRewriter(ICrossModuleIncludeResolver& InIncludeResolver);
+
+	/** Loads raw contents of the file, converting them to UTF-8 if the file has been saved as UTF-16 */
+	static bool LoadFileContents(const FString& Filename, TArray<uint8>& OutFileContents);
+
+	/** Converts the file contents to UTF-8 in place if they have been saved as UTF-16. Returns true if the contents have been converted */
+	static bool ConvertUTF16ContentsToUTF8(TArray<uint8>& FileContents);
+
+	/** Finds the include markers inside of the file contents without resolving them, malformed markers are reported and skipped */
+	static void FindIncludeMarkers(const FString& HeaderFileName, const TArray<uint8>& FileContents, TArray<FHeaderIncludeMarker>& OutMarkers);
+
+	/**
+	 * Reads the file in chunks of the given size, finding the include markers and hashing the contents on the way. Only the last unfinished line is carried over between the chunks
+	 * Returns false if the file cannot be read, or if it has been saved as UTF-16, in which case it needs to be loaded as a whole to be converted
+	 */
+	static bool ScanFileInChunks(const FString& Filename, int64 ChunkSize, FHeaderFileScan& OutFileScan);
+
+	/** Finds the include markers inside of the file contents and resolves them into the line replacements. Markers of the objects with the forward declarations are replaced with them */
+	void ResolveIncludeMarkers(const FString& HeaderFileName, const TArray<uint8>& FileContents, TArray<FHeaderLineReplacement>& OutReplacements, const TMap<FCrossModuleIncludeKey, FString>* ForwardDeclarations = NULL) const;
+
+	/** Resolves the include markers that have already been found into the line replacements */
+	void ResolveIncludeMarkers(const FString& HeaderFileName, const TArray<FHeaderIncludeMarker>& IncludeMarkers, TArray<FHeaderLineReplacement>& OutReplacements, const TMap<FCrossModuleIncludeKey, FString>* ForwardDeclarations = NULL) const;
+
+	/**
+	 * Checks whenever the header only references the class of the object through pointers, references, or the class, weak, soft and lazy pointer templates,
+	 * so it can be forward declared instead of being included. Only the classes are considered, since the structs are mostly used by value
+	 */
+	static bool FindForwardDeclarableClass(const FString& FileContents, const FString& ObjectName, FString& OutClassName);
+
+	/**
+	 * Returns the byte offset of the line following the first include of the file, ignoring the ones inside of the block comments and #if 0 blocks,
+	 * or the offset following the byte order mark when the file does not have any
+	 * bOutAfterUnterminatedLine is set when the include is the last line of the file and has no line terminator
+	 */
+	static int64 FindIncludeInsertionOffset(const TArray<uint8>& FileContents, bool& bOutAfterUnterminatedLine);
+
+	/**
+	 * Writes the file contents with the replaced lines spliced in, and returns the hash and the size of the written data
+	 * Existing file with exactly the same contents is not written again, which is reported through bOutUnchanged
+	 */
+	static bool WriteRewrittenFile(const FString& Filename, const TArray<uint8>& FileContents, const TArray<FHeaderLineReplacement>& Replacements, FString& OutOutputHash, int64& OutBytesWritten, bool& bOutUnchanged);
+
+	/** Same as above, but copies the untouched spans from the scanned source file in chunks of the given size */
+	static bool WriteRewrittenFileInChunks(const FString& Filename, const FString& SourceFilename, const FHeaderFileScan& SourceFileScan, int64 ChunkSize, const TArray<FHeaderLineReplacement>& Replacements, FString& OutOutputHash, int64& OutBytesWritten, bool& bOutUnchanged);
+
+	static const ANSICHAR CrossModuleIncludePrefix[];
+private:
+	/** Parses the single line of the file into the include marker if it starts with the marker prefix */
+	static void ParseIncludeMarkerLine(const FString& HeaderFileName, const uint8* LineStart, int64 LineLength, int64 LineOffset, TArray<FHeaderIncludeMarker>& OutMarkers);
+
+	ICrossModuleIncludeResolver& IncludeResolver;
+};
@@ -0,0 +1,382 @@
+#include "HeaderSplitter.h"
+#include "ProjectGenerator.h"
+#include "HeaderFileRewriter.h"
+
+/** Reflected type of the dumped header, along with the lines going into its own header */
+struct FReflectedTypeSegment {
+	FString TypeName;
+	/** Type name without the prefix, which is the name the include markers reference it by and the name of its header */
+	FString ObjectName;
+	bool bIsInterface = false;
+	TArray<FString> Lines;
+	/** Types and delegates declared by the lines, which make the other segments using them include this one */
+	TSet<FString> DeclaredNames;
+	TSet<FString> Identifiers;
+};
+
+//Tracks the brace and parenthesis depth through the line, skipping the comments, string and character literals
+static void ScanCodeLine(const FString& Line, bool& bInBlockComment, int32& BraceDepth, int32& ParenDepth, bool& bOutOpenedBrace) {
+	const int32 LineLength = Line.Len();
+
+	for (int32 CharIndex = 0; CharIndex < LineLength; CharIndex++) {
+		const TCHAR Char = Line[CharIndex];
+		const TCHAR NextChar = CharIndex + 1 < LineLength ? Line[CharIndex + 1] : TEXT('\0');
+
+		if (bInBlockComment) {
+			if (Char == TEXT('*') && NextChar == TEXT('/')) {
+				bInBlockComment = false;
+				CharIndex++;
+			}
+			continue;
+		}
+		if (Char == TEXT('/') && NextChar == TEXT('/')) {
+			return;
+		}
+		if (Char == TEXT('/') && NextChar == TEXT('*')) {
+			bInBlockComment = true;
+			CharIndex++;
+			continue;
+		}
+		if (Char == TEXT('"') || Char == TEXT('\'')) {
+			for (CharIndex++; CharIndex < LineLength && Line[CharIndex] != Char; CharIndex++) {
+				if (Line[CharIndex] == TEXT('\\')) {
+					CharIndex++;
+				}
+			}
+			continue;
+		}
+
+		if (Char == TEXT('{')) {
+			BraceDepth++;
+			bOutOpenedBrace = true;
+		} else if (Char == TEXT('}')) {
+			BraceDepth--;
+		} else if (Char == TEXT('(')) {
+			ParenDepth++;
+		} else if (Char == TEXT(')')) {
+			ParenDepth--;
+		}
+	}
+}
+
+static void CollectIdentifiers(const FString& Line, TArray<FString>& OutIdentifiers) {
+	int32 IdentifierStart = INDEX_NONE;
+	for (int32 CharIndex = 0; CharIndex <= Line.Len(); CharIndex++) {
+		const bool bIsIdentifierChar = CharIndex < Line.Len() && (FChar::IsAlnum(Line[CharIndex]) || Line[CharIndex] == TEXT('_'));
+
+		if (bIsIdentifierChar && IdentifierStart == INDEX_NONE) {
+			IdentifierStart = CharIndex;
+		} else if (!bIsIdentifierChar && IdentifierStart != INDEX_NONE) {
+			OutIdentifiers.Add(Line.Mid(IdentifierStart, CharIndex - IdentifierStart));
+			IdentifierStart = INDEX_NONE;
+		}
+	}
+}
+
+//Returns the name of the class, struct, enum or namespace declared by the line, skipping the API macros
+static bool ParseDeclaredTypeName(const FString& Line, FString& OutTypeName) {
+	TArray<FString> Tokens;
+	CollectIdentifiers(Line, Tokens);
+
+	int32 TokenIndex = 0;
+	if (Tokens.Num() && (Tokens[0] == TEXT("class") || Tokens[0] == TEXT("struct") || Tokens[0] == TEXT("namespace"))) {
+		TokenIndex = 1;
+	} else if (Tokens.Num() && Tokens[0] == TEXT("enum")) {
+		TokenIndex = Tokens.Num() > 1 && (Tokens[1] == TEXT("class") || Tokens[1] == TEXT("struct")) ? 2 : 1;
+	} else {
+		return false;
+	}
+	while (TokenIndex < Tokens.Num() && Tokens[TokenIndex].EndsWith(TEXT("_API"), ESearchCase::CaseSensitive)) {
+		TokenIndex++;
+	}
+	if (TokenIndex >= Tokens.Num()) {
+		return false;
+	}
+	OutTypeName = Tokens[TokenIndex];
+	return true;
+}
+
+//Dynamic delegates are reflected too, and are declared by the macros taking their name as the first argument
+static bool ParseDeclaredDelegateName(const FString& TrimmedLine, FString& OutDelegateName) {
+	int32 ArgumentsStart = INDEX_NONE;
+	if (!TrimmedLine.StartsWith(TEXT("DECLARE_"), ESearchCase::CaseSensitive) || !TrimmedLine.Contains(TEXT("DELEGATE"), ESearchCase::CaseSensitive) || !TrimmedLine.FindChar(TEXT('('), ArgumentsStart)) {
+		return false;
+	}
+	TArray<FString> Arguments;
+	CollectIdentifiers(TrimmedLine.Mid(ArgumentsStart + 1), Arguments);
+	if (Arguments.Num() == 0) {
+		return false;
+	}
+	OutDelegateName = Arguments[0];
+	return true;
+}
+
+static bool ParseReflectionMacro(const FString& TrimmedLine, FString& OutMacroName) {
+	static const TCHAR* ReflectionMacros[] = {TEXT("UCLASS"), TEXT("USTRUCT"), TEXT("UENUM"), TEXT("UINTERFACE")};
+
+	for (const TCHAR* ReflectionMacro : ReflectionMacros) {
+		if (TrimmedLine.StartsWith(ReflectionMacro, ESearchCase::CaseSensitive) && TrimmedLine.Mid(FCString::Strlen(ReflectionMacro)).TrimStart().StartsWith(TEXT("("))) {
+			OutMacroName = ReflectionMacro;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool IsForwardDeclaration(const FString& TrimmedLine) {
+	TArray<FString> Tokens;
+	CollectIdentifiers(TrimmedLine, Tokens);
+	return Tokens.Num() == 2 && (Tokens[0] == TEXT("class") || Tokens[0] == TEXT("struct")) && TrimmedLine.EndsWith(TEXT(";"));
+}
+
+bool FHeaderSplitter::SplitHeader(const FString& HeaderFileName, const TArray<uint8>& FileContents, const FString& IncludeDirectory, TSet<FString>& InOutModuleHeaderNames, TArray<FSplitHeaderFile>& OutSplitHeaders, TArray<uint8>& OutRemainingContents) {
+	const FUTF8ToTCHAR FileContentsConverter((const ANSICHAR*) FileContents.GetData(), FileContents.Num());
+	const FString FileContentsString(FileContentsConverter.Length(), FileContentsConverter.Get());
+	const TCHAR* LineTerminator = FileContentsString.Contains(TEXT("\r\n")) ? TEXT("\r\n") : TEXT("\n");
+
+	TArray<FString> Lines;
+	FileContentsString.ParseIntoArray(Lines, TEXT("\n"), false);
+	for (FString& Line : Lines) {
+		Line.RemoveFromEnd(TEXT("\r"));
+	}
+	if (Lines.Num() && Lines.Last().IsEmpty()) {
+		Lines.Pop();
+	}
+
+	//Everything up to the generated include is shared by all of the split headers
+	const FString GeneratedInclude = FString::Printf(TEXT("#include \"%s.generated.h\""), *FPaths::GetBaseFilename(HeaderFileName));
+	const int32 GeneratedIncludeIndex = Lines.IndexOfByPredicate([&](const FString& Line) {
+		return Line.TrimStartAndEnd() == GeneratedInclude;
+	});
+	if (GeneratedIncludeIndex == INDEX_NONE) {
+		return false;
+	}
+	const TArray<FString> PrologueLines(Lines.GetData(), GeneratedIncludeIndex);
+	const bool bHasPragmaOnce = PrologueLines.ContainsByPredicate([](const FString& Line) {
+		return Line.TrimStartAndEnd() == TEXT("#pragma once");
+	});
+	if (!bHasPragmaOnce) {
+		return false;
+	}
+
+	TArray<FReflectedTypeSegment> Segments;
+	TArray<FString> ForwardDeclarations;
+	TArray<FString> PendingLines;
+	int32 BraceDepth = 0;
+	bool bInBlockComment = false;
+
+	for (int32 LineIndex = GeneratedIncludeIndex + 1; LineIndex < Lines.Num(); LineIndex++) {
+		const FString TrimmedLine = Lines[LineIndex].TrimStartAndEnd();
+		const bool bAtTopLevel = !bInBlockComment && BraceDepth == 0;
+
+		//Preprocessor directives and include markers after the generated include would end up in the wrong headers
+		if (bAtTopLevel && (TrimmedLine.StartsWith(TEXT("#")) || TrimmedLine.StartsWith(ANSI_TO_TCHAR(FHeaderFileRewriter::CrossModuleIncludePrefix)))) {
+			UE_LOG(LogProjectGenerator, Verbose, TEXT("Not splitting header %s with the directives after the generated include"), *HeaderFileName);
+			return false;
+		}
+
+		FString MacroName;
+		if (bAtTopLevel && ParseReflectionMacro(TrimmedLine, MacroName)) {
+			//Lines between the types go with the type following them, except for the ones after the interface, which hold its native interface class
+			TArray<FString> SegmentLines;
+			if (Segments.Num() && Segments.Last().bIsInterface) {
+				Segments.Last().Lines.Append(PendingLines);
+			} else {
+				SegmentLines = PendingLines;
+			}
+			PendingLines.Reset();
+
+			//Specifiers of the macro can span multiple lines
+			int32 MacroBraceDepth = 0;
+			int32 MacroParenDepth = 0;
+			bool bMacroOpenedBrace = false;
+			SegmentLines.Add(Lines[LineIndex]);
+			ScanCodeLine(Lines[LineIndex], bInBlockComment, MacroBraceDepth, MacroParenDepth, bMacroOpenedBrace);
+
+			while (MacroParenDepth > 0) {
+				if (++LineIndex >= Lines.Num()) {
+					return false;
+				}
+				SegmentLines.Add(Lines[LineIndex]);
+				ScanCodeLine(Lines[LineIndex], bInBlockComment, MacroBraceDepth, MacroParenDepth, bMacroOpenedBrace);
+			}
+
+			//Declaration of the type follows the macro, and its body ends with the line closing the outermost brace
+			while (++LineIndex < Lines.Num() && Lines[LineIndex].TrimStartAndEnd().IsEmpty()) {
+				SegmentLines.Add(Lines[LineIndex]);
+			}
+			FString TypeName;
+			if (LineIndex >= Lines.Num() || !ParseDeclaredTypeName(Lines[LineIndex], TypeName)) {
+				UE_LOG(LogProjectGenerator, Verbose, TEXT("Not splitting header %s, %s is not followed by the type declaration"), *HeaderFileName, *MacroName);
+				return false;
+			}
+
+			bool bOpenedBrace = false;
+			int32 BodyParenDepth = 0;
+			while (true) {
+				SegmentLines.Add(Lines[LineIndex]);
+				ScanCodeLine(Lines[LineIndex], bInBlockComment, BraceDepth, BodyParenDepth, bOpenedBrace);
+
+				if (bOpenedBrace && BraceDepth == 0) {
+					break;
+				}
+				if (BraceDepth < 0 || ++LineIndex >= Lines.Num()) {
+					return false;
+				}
+			}
+
+			FReflectedTypeSegment& Segment = Segments.AddDefaulted_GetRef();
+			Segment.TypeName = TypeName;
+			Segment.ObjectName = MacroName == TEXT("UENUM") || TypeName.Len() < 2 ? TypeName : TypeName.Mid(1);
+			Segment.bIsInterface = MacroName == TEXT("UINTERFACE");
+			Segment.Lines = MoveTemp(SegmentLines);
+			continue;
+		}
+
+		//Forward declarations can be needed by any of the types, so every header gets all of them
+		if (bAtTopLevel && IsForwardDeclaration(TrimmedLine)) {
+			ForwardDeclarations.AddUnique(TrimmedLine);
+			continue;
+		}
+
+		int32 ParenDepth = 0;
+		bool bOpenedBrace = false;
+		ScanCodeLine(Lines[LineIndex], bInBlockComment, BraceDepth, ParenDepth, bOpenedBrace);
+		if (BraceDepth < 0) {
+			return false;
+		}
+		PendingLines.Add(Lines[LineIndex]);
+	}
+
+	if (Segments.Num() < 2 || BraceDepth != 0 || bInBlockComment) {
+		return false;
+	}
+	Segments.Last().Lines.Append(PendingLines);
+
+	//Types are split out until the first one which header name is taken, then it stays in the original header along with all of the types following it
+	int32 NumSplitSegments = 0;
+	while (NumSplitSegments < Segments.Num() && !InOutModuleHeaderNames.Contains(Segments[NumSplitSegments].ObjectName)) {
+		InOutModuleHeaderNames.Add(Segments[NumSplitSegments].ObjectName);
+		NumSplitSegments++;
+	}
+	if (NumSplitSegments == 0) {
+		return false;
+	}
+
+	for (FReflectedTypeSegment& Segment : Segments) {
+		Segment.DeclaredNames.Add(Segment.TypeName);
+		if (Segment.bIsInterface) {
+			Segment.DeclaredNames.Add(TEXT("I") + Segment.ObjectName);
+		}
+		for (const FString& Line : Segment.Lines) {
+			FString DeclaredName;
+			if (ParseDeclaredTypeName(Line, DeclaredName) || ParseDeclaredDelegateName(Line.TrimStart(), DeclaredName)) {
+				Segment.DeclaredNames.Add(DeclaredName);
+			}
+			TArray<FString> LineIdentifiers;
+			CollectIdentifiers(Line, LineIdentifiers);
+			Segment.Identifiers.Append(LineIdentifiers);
+		}
+	}
+
+	auto MakeSplitHeaderInclude = [&](const FReflectedTypeSegment& Segment) {
+		const FString SplitHeaderFilename = Segment.ObjectName + TEXT(".h");
+		return FString::Printf(TEXT("#include \"%s\""), IncludeDirectory.IsEmpty() ? *SplitHeaderFilename : *(IncludeDirectory / SplitHeaderFilename));
+	};
+	auto AppendTypeLines = [&](TArray<FString>& OutLines, const TArray<FString>& TypeLines) {
+		int32 FirstLine = 0;
+		int32 LastLine = TypeLines.Num() - 1;
+		while (FirstLine <= LastLine && TypeLines[FirstLine].TrimStartAndEnd().IsEmpty()) {
+			FirstLine++;
+		}
+		while (LastLine >= FirstLine && TypeLines[LastLine].TrimStartAndEnd().IsEmpty()) {
+			LastLine--;
+		}
+		OutLines.Add(FString());
+		if (ForwardDeclarations.Num()) {
+			OutLines.Append(ForwardDeclarations);
+			OutLines.Add(FString());
+		}
+		for (int32 LineIndex = FirstLine; LineIndex <= LastLine; LineIndex++) {
+			OutLines.Add(TypeLines[LineIndex]);
+		}
+	};
+	auto ConvertLinesToUTF8 = [&](const TArray<FString>& OutLines, TArray<uint8>& OutContents) {
+		const FString Contents = FString::Join(OutLines, LineTerminator) + LineTerminator;
+		const FTCHARToUTF8 ContentsUTF8(*Contents);
+		OutContents.Reset();
+		OutContents.Append((const uint8*) ContentsUTF8.Get(), ContentsUTF8.Length());
+	};
+
+	for (int32 SegmentIndex = 0; SegmentIndex < NumSplitSegments; SegmentIndex++) {
+		const FReflectedTypeSegment& Segment = Segments[SegmentIndex];
+		TArray<FString> HeaderLines = PrologueLines;
+
+		//Only the preceding types can be used by value, the following ones are referenced through the forward declarations like in the original header
+		for (int32 OtherSegmentIndex = 0; OtherSegmentIndex < SegmentIndex; OtherSegmentIndex++) {
+			for (const FString& DeclaredName : Segments[OtherSegmentIndex].DeclaredNames) {
+				if (Segment.Identifiers.Contains(DeclaredName)) {
+					HeaderLines.Add(MakeSplitHeaderInclude(Segments[OtherSegmentIndex]));
+					break;
+				}
+			}
+		}
+		HeaderLines.Add(FString::Printf(TEXT("#include \"%s.generated.h\""), *Segment.ObjectName));
+		AppendTypeLines(HeaderLines, Segment.Lines);
+
+		FSplitHeaderFile& SplitHeader = OutSplitHeaders.AddDefaulted_GetRef();
+		SplitHeader.Filename = Segment.ObjectName + TEXT(".h");
+		SplitHeader.ObjectNames.Add(Segment.ObjectName);
+		ConvertLinesToUTF8(HeaderLines, SplitHeader.Contents);
+	}
+
+	//Original header includes all of the split ones, and keeps the types that could not be split along with its generated include
+	TArray<FString> RemainingLines = PrologueLines;
+	for (int32 SegmentIndex = 0; SegmentIndex < NumSplitSegments; SegmentIndex++) {
+		RemainingLines.Add(MakeSplitHeaderInclude(Segments[SegmentIndex]));
+	}
+	if (NumSplitSegments < Segments.Num()) {
+		TArray<FString> RemainingTypeLines;
+		for (int32 SegmentIndex = NumSplitSegments; SegmentIndex < Segments.Num(); SegmentIndex++) {
+			RemainingTypeLines.Append(Segments[SegmentIndex].Lines);
+		}
+		RemainingLines.Add(Lines[GeneratedIncludeIndex]);
+		AppendTypeLines(RemainingLines, RemainingTypeLines);
+	}
+	ConvertLinesToUTF8(RemainingLines, OutRemainingContents);
+	return true;
+}
+
+FString FHeaderSplitter::GetModuleIncludePath(const FString& ModuleRelativePath) {
+	static const TCHAR PublicFolderName[]  = TEXT("Public/");
+	static const TCHAR PrivateFolderName[] = TEXT("Private/");
+	static const TCHAR ClassesFolderName[] = TEXT("Classes/");
+
+	FString IncludePath = ModuleRelativePath;
+	IncludePath.RemoveFromStart(TEXT("/"));
+	IncludePath.RemoveFromStart(PublicFolderName, ESearchCase::CaseSensitive);
+	IncludePath.RemoveFromStart(PrivateFolderName, ESearchCase::CaseSensitive);
+	IncludePath.RemoveFromStart(ClassesFolderName, ESearchCase::CaseSensitive);
+	return IncludePath;
+}
+
+FSplitHeaderIncludeResolver::FSplitHeaderIncludeResolver(ICrossModuleIncludeResolver& InInnerResolver) : InnerResolver(InInnerResolver) {
+}
+
+void FSplitHeaderIncludeResolver::AddSplitObject(const FString& ModuleName, const FString& ObjectName, const FString& IncludePath) {
+	ModuleObjectIncludePaths.FindOrAdd(ModuleName).Add(ObjectName, IncludePath);
+}
+
+bool FSplitHeaderIncludeResolver::ResolveInclude(const FString& HeaderFileName, const FCrossModuleIncludeKey& IncludeKey, FString& OutIncludeString) {
+	if (const TMap<FString, FString>* ObjectIncludePaths = ModuleObjectIncludePaths.Find(IncludeKey.ModuleName)) {
+		if (const FString* IncludePath = ObjectIncludePaths->Find(IncludeKey.ObjectName)) {
+			OutIncludeString = FString::Printf(TEXT("#include \"%s\""), **IncludePath);
+			return true;
+		}
+	}
+	return InnerResolver.ResolveInclude(HeaderFileName, IncludeKey, OutIncludeString);
+}
+
+void FSplitHeaderIncludeResolver::PrepareIncludes(const TMap<FCrossModuleIncludeKey, FString>& ReferencedObjects, const TSet<FString>& ReferencedModules) {
+	InnerResolver.PrepareIncludes(ReferencedObjects, ReferencedModules);
+}
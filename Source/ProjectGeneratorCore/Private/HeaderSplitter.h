@@ -0,0 +1,55 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ICrossModuleIncludeResolver.h"
+
+/** Header holding the single reflected type moved out of the dumped header */
+struct FSplitHeaderFile {
+	/** Name of the header file, placed into the same directory as the header it has been split from */
+	FString Filename;
+	TArray<uint8> Contents;
+	/** Names of the objects declared by the header, the same way the include markers reference them */
+	TArray<FString> ObjectNames;
+};
+
+/**
+ * Splits the dumped headers declaring multiple UCLASS, USTRUCT, UENUM or UINTERFACE types into one header per type, named after the object like UHT expects,
+ * so the files needing one of the types do not have to preprocess and run UHT on all of them.
+ * Split headers keep all of the includes of the original one, and include the other split headers declaring the types they use.
+ * Original header includes all of the split headers, so the files including it keep compiling
+ */
+class FHeaderSplitter {
+public:
+	/**
+	 * Splits the header into the headers of its reflected types, stopping at the first type which name is already taken by another header of the module,
+	 * which stays in the original header together with the types following it. Names of the split headers are added to the taken ones.
+	 * Returns false when the header declares less than two types, or has the layout that cannot be split safely, like conditional compilation after the generated include
+	 */
+	static bool SplitHeader(const FString& HeaderFileName, const TArray<uint8>& FileContents, const FString& IncludeDirectory, TSet<FString>& InOutModuleHeaderNames, TArray<FSplitHeaderFile>& OutSplitHeaders, TArray<uint8>& OutRemainingContents);
+
+	/** Converts the path of the file relative to the module directory into the include path, stripping the Public, Private and Classes directories like UHT does for ModuleRelativePath */
+	static FString GetModuleIncludePath(const FString& ModuleRelativePath);
+};
+
+/**
+ * Resolves the objects moved into the split headers to them, and passes everything else to the wrapped resolver
+ * Split headers are registered before any of the files are rewritten, so the lookups do not need to be synchronized
+ */
+class FSplitHeaderIncludeResolver : public ICrossModuleIncludeResolver {
+public:
+	explicit FSplitHeaderIncludeResolver(ICrossModuleIncludeResolver& InInnerResolver);
+
+	void AddSplitObject(const FString& ModuleName, const FString& ObjectName, const FString& IncludePath);
+
+	virtual bool ResolveInclude(const FString& HeaderFileName, const FCrossModuleIncludeKey& IncludeKey, FString& OutIncludeString) override;
+	virtual void PrepareIncludes(const TMap<FCrossModuleIncludeKey, FString>& ReferencedObjects, const TSet<FString>& ReferencedModules) override;
+	virtual void LogCacheStatistics() const override { InnerResolver.LogCacheStatistics(); }
+
+	virtual int32 GetCacheHits() const override { return InnerResolver.GetCacheHits(); }
+	virtual int32 GetCacheMisses() const override { return InnerResolver.GetCacheMisses(); }
+	virtual int32 GetModulesForceLoaded() const override { return InnerResolver.GetModulesForceLoaded(); }
+	virtual double GetModuleLoadingSeconds() const override { return InnerResolver.GetModuleLoadingSeconds(); }
+private:
+	ICrossModuleIncludeResolver& InnerResolver;
+	/** Include paths of the split headers, keyed by the module and the object name */
+	TMap<FString, TMap<FString, FString>> ModuleObjectIncludePaths;
+};
@@ -0,0 +1,317 @@
+#include "IncludeDatabase.h"
+#include "ProjectGenerator.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+
+//Database is stored in the native byte order, it is only ever consumed on the little endian desktop platforms
+static const uint32 IncludeDatabaseMagic = 0x44494750; //PGID
+static const uint32 IncludeDatabaseVersion = 1;
+
+//File layout is the header, followed by the module entries, object entries and the string table with null terminated UTF-8 strings
+struct FIncludeDatabase::FHeader {
+	uint32 Magic;
+	uint32 Version;
+	uint32 NumModules;
+	uint32 NumObjects;
+	uint32 StringTableSize;
+	uint32 EngineVersionOffset;
+};
+
+struct FIncludeDatabase::FModuleEntry {
+	uint32 NameOffset;
+	uint32 FirstObjectIndex;
+	uint32 NumObjects;
+};
+
+struct FIncludeDatabase::FObjectEntry {
+	uint32 NameOffset;
+	uint32 IncludePathOffset;
+};
+
+//Default string keys are case insensitive, but the string table needs to preserve the case of the names and include paths
+struct FCaseSensitiveStringKeyFuncs : BaseKeyFuncs<TPair<FString, uint32>, FString> {
+	static const FString& GetSetKey(const TPair<FString, uint32>& Element) {
+		return Element.Key;
+	}
+	static bool Matches(const FString& A, const FString& B) {
+		return A.Equals(B, ESearchCase::CaseSensitive);
+	}
+	static uint32 GetKeyHash(const FString& Key) {
+		return FCrc::StrCrc32(*Key);
+	}
+};
+
+FIncludeDatabase::FIncludeDatabase() : Header(NULL), Modules(NULL), Objects(NULL), StringTable(NULL) {
+}
+
+FIncludeDatabase::~FIncludeDatabase() {
+	//Region needs to be unmapped before the file handle is closed
+	MappedFileRegion.Reset();
+	MappedFileHandle.Reset();
+}
+
+bool FIncludeDatabase::Load(const FString& DatabaseFilePath) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedFileRegion.Reset();
+	MappedFileHandle.Reset(PlatformFile.OpenMapped(*DatabaseFilePath));
+
+	if (MappedFileHandle.IsValid()) {
+		MappedFileRegion.Reset(MappedFileHandle->MapRegion());
+	}
+	if (MappedFileRegion.IsValid()) {
+		return InitializeFromData(MappedFileRegion->GetMappedPtr(), MappedFileRegion->GetMappedSize(), DatabaseFilePath);
+	}
+
+	if (!FFileHelper::LoadFileToArray(LoadedFileContents, *DatabaseFilePath)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Cannot read include database %s"), *DatabaseFilePath);
+		return false;
+	}
+	return InitializeFromData(LoadedFileContents.GetData(), LoadedFileContents.Num(), DatabaseFilePath);
+}
+
+bool FIncludeDatabase::InitializeFromData(const uint8* Data, int64 DataSize, const FString& DatabaseFilePath) {
+	Header = NULL;
+	if (DataSize < (int64) sizeof(FHeader)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Include database %s is truncated"), *DatabaseFilePath);
+		return false;
+	}
+
+	const FHeader* FileHeader = (const FHeader*) Data;
+	if (FileHeader->Magic != IncludeDatabaseMagic || FileHeader->Version != IncludeDatabaseVersion) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Include database %s has been exported by the incompatible version of the generator"), *DatabaseFilePath);
+		return false;
+	}
+
+	const int64 ModulesOffset = sizeof(FHeader);
+	const int64 ObjectsOffset = ModulesOffset + (int64) FileHeader->NumModules * sizeof(FModuleEntry);
+	const int64 StringTableOffset = ObjectsOffset + (int64) FileHeader->NumObjects * sizeof(FObjectEntry);
+
+	if (StringTableOffset + FileHeader->StringTableSize != DataSize || FileHeader->StringTableSize == 0 || Data[DataSize - 1] != 0) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Include database %s is corrupted"), *DatabaseFilePath);
+		return false;
+	}
+
+	const FModuleEntry* FileModules = (const FModuleEntry*) (Data + ModulesOffset);
+	const FObjectEntry* FileObjects = (const FObjectEntry*) (Data + ObjectsOffset);
+
+	//Validate all of the references once, so the lookups never need to check them
+	bool bOffsetsValid = FileHeader->EngineVersionOffset < FileHeader->StringTableSize;
+	for (uint32 ModuleIndex = 0; ModuleIndex < FileHeader->NumModules; ModuleIndex++) {
+		const FModuleEntry& ModuleEntry = FileModules[ModuleIndex];
+		bOffsetsValid &= ModuleEntry.NameOffset < FileHeader->StringTableSize &&
+			(uint64) ModuleEntry.FirstObjectIndex + ModuleEntry.NumObjects <= FileHeader->NumObjects;
+	}
+	for (uint32 ObjectIndex = 0; ObjectIndex < FileHeader->NumObjects; ObjectIndex++) {
+		const FObjectEntry& ObjectEntry = FileObjects[ObjectIndex];
+		bOffsetsValid &= ObjectEntry.NameOffset < FileHeader->StringTableSize && ObjectEntry.IncludePathOffset < FileHeader->StringTableSize;
+	}
+	if (!bOffsetsValid) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Include database %s is corrupted"), *DatabaseFilePath);
+		return false;
+	}
+
+	Header = FileHeader;
+	Modules = FileModules;
+	Objects = FileObjects;
+	StringTable = (const ANSICHAR*) (Data + StringTableOffset);
+	return true;
+}
+
+const ANSICHAR* FIncludeDatabase::GetString(uint32 StringOffset) const {
+	return StringTable + StringOffset;
+}
+
+const FIncludeDatabase::FModuleEntry* FIncludeDatabase::FindModule(const ANSICHAR* ModuleName) const {
+	if (Header == NULL) {
+		return NULL;
+	}
+	const TArrayView<const FModuleEntry> AllModules(Modules, Header->NumModules);
+
+	const int32 ModuleIndex = Algo::LowerBound(AllModules, ModuleName, [&](const FModuleEntry& ModuleEntry, const ANSICHAR* Name) {
+		return FCStringAnsi::Stricmp(GetString(ModuleEntry.NameOffset), Name) < 0;
+	});
+	if (ModuleIndex < AllModules.Num() && FCStringAnsi::Stricmp(GetString(AllModules[ModuleIndex].NameOffset), ModuleName) == 0) {
+		return &AllModules[ModuleIndex];
+	}
+	return NULL;
+}
+
+bool FIncludeDatabase::ContainsModule(const FString& ModuleName) const {
+	return FindModule(TCHAR_TO_UTF8(*ModuleName)) != NULL;
+}
+
+bool FIncludeDatabase::FindIncludePath(const FString& ModuleName, const FString& ObjectName, FString& OutIncludePath) const {
+	const FModuleEntry* ModuleEntry = FindModule(TCHAR_TO_UTF8(*ModuleName));
+	if (ModuleEntry == NULL) {
+		return false;
+	}
+
+	const FTCHARToUTF8 ObjectNameUTF8(*ObjectName);
+	const TArrayView<const FObjectEntry> ModuleObjects(Objects + ModuleEntry->FirstObjectIndex, ModuleEntry->NumObjects);
+
+	const int32 ObjectIndex = Algo::LowerBound(ModuleObjects, ObjectNameUTF8.Get(), [&](const FObjectEntry& ObjectEntry, const ANSICHAR* Name) {
+		return FCStringAnsi::Stricmp(GetString(ObjectEntry.NameOffset), Name) < 0;
+	});
+	if (ObjectIndex < ModuleObjects.Num() && FCStringAnsi::Stricmp(GetString(ModuleObjects[ObjectIndex].NameOffset), ObjectNameUTF8.Get()) == 0) {
+		OutIncludePath = UTF8_TO_TCHAR(GetString(ModuleObjects[ObjectIndex].IncludePathOffset));
+		return true;
+	}
+	return false;
+}
+
+int32 FIncludeDatabase::GetNumModules() const {
+	return Header != NULL ? Header->NumModules : 0;
+}
+
+FString FIncludeDatabase::GetEngineVersion() const {
+	return Header != NULL ? FString(UTF8_TO_TCHAR(GetString(Header->EngineVersionOffset))) : FString();
+}
+
+bool FIncludeDatabase::Save(const FString& DatabaseFilePath, const FString& EngineVersion, const TMap<FString, TMap<FString, FString>>& ModuleObjectIncludePaths) {
+	//Strings are stored once and referenced by the offset, empty string always lives at the start of the table
+	TArray<uint8> StringTableData;
+	TMap<FString, uint32, FDefaultSetAllocator, FCaseSensitiveStringKeyFuncs> StringOffsets;
+	StringTableData.Add(0);
+	StringOffsets.Add(FString(), 0);
+
+	auto AddString = [&](const FString& String) {
+		if (const uint32* ExistingOffset = StringOffsets.Find(String)) {
+			return *ExistingOffset;
+		}
+		const uint32 StringOffset = StringTableData.Num();
+		const FTCHARToUTF8 StringUTF8(*String);
+		StringTableData.Append((const uint8*) StringUTF8.Get(), StringUTF8.Length());
+		StringTableData.Add(0);
+		StringOffsets.Add(String, StringOffset);
+		return StringOffset;
+	};
+
+	//Sorted the same way lookups compare the names, which also makes the file identical between the exports from the same engine
+	auto CompareNames = [](const FString& A, const FString& B) {
+		return FCStringAnsi::Stricmp(TCHAR_TO_UTF8(*A), TCHAR_TO_UTF8(*B)) < 0;
+	};
+
+	TArray<FString> ModuleNames;
+	ModuleObjectIncludePaths.GetKeys(ModuleNames);
+	ModuleNames.Sort(CompareNames);
+
+	TArray<FModuleEntry> ModuleEntries;
+	TArray<FObjectEntry> ObjectEntries;
+
+	for (const FString& ModuleName : ModuleNames) {
+		const TMap<FString, FString>& ObjectIncludePaths = ModuleObjectIncludePaths.FindChecked(ModuleName);
+
+		TArray<FString> ObjectNames;
+		ObjectIncludePaths.GetKeys(ObjectNames);
+		ObjectNames.Sort(CompareNames);
+
+		FModuleEntry& ModuleEntry = ModuleEntries.AddDefaulted_GetRef();
+		ModuleEntry.NameOffset = AddString(ModuleName);
+		ModuleEntry.FirstObjectIndex = ObjectEntries.Num();
+		ModuleEntry.NumObjects = ObjectNames.Num();
+
+		for (const FString& ObjectName : ObjectNames) {
+			FObjectEntry& ObjectEntry = ObjectEntries.AddDefaulted_GetRef();
+			ObjectEntry.NameOffset = AddString(ObjectName);
+			ObjectEntry.IncludePathOffset = AddString(ObjectIncludePaths.FindChecked(ObjectName));
+		}
+	}
+
+	FHeader FileHeader;
+	FileHeader.Magic = IncludeDatabaseMagic;
+	FileHeader.Version = IncludeDatabaseVersion;
+	FileHeader.NumModules = ModuleEntries.Num();
+	FileHeader.NumObjects = ObjectEntries.Num();
+	FileHeader.EngineVersionOffset = AddString(EngineVersion);
+	FileHeader.StringTableSize = StringTableData.Num();
+
+	TArray<uint8> DatabaseFileContents;
+	DatabaseFileContents.Append((const uint8*) &FileHeader, sizeof(FHeader));
+	DatabaseFileContents.Append((const uint8*) ModuleEntries.GetData(), ModuleEntries.Num() * sizeof(FModuleEntry));
+	DatabaseFileContents.Append((const uint8*) ObjectEntries.GetData(), ObjectEntries.Num() * sizeof(FObjectEntry));
+	DatabaseFileContents.Append(StringTableData);
+
+	return FFileHelper::SaveArrayToFile(DatabaseFileContents, *DatabaseFilePath);
+}
+
+bool FIncludeDatabaseResolver::Load(const FString& DatabaseFilePath) {
+	if (!IncludeDatabase.Load(DatabaseFilePath)) {
+		return false;
+	}
+
+	//Include paths depend on the engine the database has been exported from, using it with the different engine is allowed but suspicious
+	const FString DatabaseEngineVersion = IncludeDatabase.GetEngineVersion();
+	if (DatabaseEngineVersion != FEngineVersion::Current().ToString()) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Include database %s has been exported from the engine version %s"), *DatabaseFilePath, *DatabaseEngineVersion);
+	}
+	UE_LOG(LogProjectGenerator, Display, TEXT("Loaded include database %s with %d modules"), *DatabaseFilePath, IncludeDatabase.GetNumModules());
+	return true;
+}
+
+bool FIncludeDatabaseResolver::ResolveInclude(const FString& HeaderFileName, const FCrossModuleIncludeKey& IncludeKey, FString& OutIncludeString) {
+	//Same objects are referenced by thousands of headers, so most of the lookups are served from the cache
+	{
+		FReadScopeLock ReadLock(ResolvedIncludeCacheLock);
+		if (const FString* CachedIncludeString = ResolvedIncludeCache.Find(IncludeKey)) {
+			CacheHits.Increment();
+			if (CachedIncludeString->IsEmpty()) {
+				return false;
+			}
+			OutIncludeString = *CachedIncludeString;
+			return true;
+		}
+	}
+	CacheMisses.Increment();
+
+	FString ResolvedIncludeString;
+	const bool bResolvedInclude = LookupInclude(IncludeKey, ResolvedIncludeString);
+	bool bAlreadyCached = false;
+	{
+		//Another worker might have resolved the same object in the meantime, only the first one to cache it warns about it
+		FWriteScopeLock WriteLock(ResolvedIncludeCacheLock);
+		bAlreadyCached = ResolvedIncludeCache.Contains(IncludeKey);
+		if (!bAlreadyCached) {
+			ResolvedIncludeCache.Add(IncludeKey, bResolvedInclude ? ResolvedIncludeString : FString());
+		}
+	}
+
+	if (!bResolvedInclude) {
+		if (bAlreadyCached) {
+			return false;
+		}
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Couldn't find native object %s inside of the module %s include database entry, referenced by %s"), *IncludeKey.ObjectName, *IncludeKey.ModuleName, *HeaderFileName);
+		return false;
+	}
+	OutIncludeString = MoveTemp(ResolvedIncludeString);
+	return true;
+}
+
+bool FIncludeDatabaseResolver::LookupInclude(const FCrossModuleIncludeKey& IncludeKey, FString& OutIncludeString) const {
+	//If module is not in the database, we assume it's one of the game modules, and generate a normal include
+	if (!IncludeDatabase.ContainsModule(IncludeKey.ModuleName)) {
+		OutIncludeString = FString::Printf(TEXT("#include \"%s.h\""), *IncludeKey.FallbackName);
+		return true;
+	}
+
+	FString ObjectIncludePath;
+	if (!IncludeDatabase.FindIncludePath(IncludeKey.ModuleName, IncludeKey.ObjectName, ObjectIncludePath) || ObjectIncludePath.IsEmpty()) {
+		return false;
+	}
+	OutIncludeString = FString::Printf(TEXT("#include \"%s\""), *ObjectIncludePath);
+	return true;
+}
+
+void FIncludeDatabaseResolver::LogCacheStatistics() const {
+	int32 UnresolvedIncludes = 0;
+	{
+		FReadScopeLock ReadLock(ResolvedIncludeCacheLock);
+		for (const TPair<FCrossModuleIncludeKey, FString>& CacheEntry : ResolvedIncludeCache) {
+			if (CacheEntry.Value.IsEmpty()) {
+				UnresolvedIncludes++;
+			}
+		}
+	}
+	UE_LOG(LogProjectGenerator, Display, TEXT("Include database cache: %d hits, %d misses (%d objects could not be resolved)"), CacheHits.GetValue(), CacheMisses.GetValue(), UnresolvedIncludes);
+}
@@ -0,0 +1,297 @@
+#include "ModuleBuildSettings.h"
+#include "ModuleDependencyGraph.h"
+
+//Headers included by a single file do not benefit from being precompiled, and a huge PCH slows down every file of the module
+static const int32 MinPCHIncludeFileCount = 2;
+static const int32 MaxPCHIncludes = 32;
+
+//Every generated module contains reflected types, so it always needs the object system and the engine
+static const TCHAR* DefaultModuleDependencies[] = {TEXT("Core"), TEXT("CoreUObject"), TEXT("Engine")};
+
+void FModuleBuildSettings::AddFileIncludes(const FString& ModuleName, const TArray<FHeaderLineReplacement>& LineReplacements) {
+	FScopeLock ScopeLock(&ModuleIncludesLock);
+	FModuleIncludes& Includes = ModuleIncludes.FindOrAdd(ModuleName);
+
+	TSet<FString> FileIncludes;
+	for (const FHeaderLineReplacement& LineReplacement : LineReplacements) {
+		//Same header can be referenced multiple times by the file, but it is only counted once
+		if (!LineReplacement.ModuleName.IsEmpty() && LineReplacement.ModuleName != ModuleName && !FileIncludes.Contains(LineReplacement.NewLine)) {
+			FileIncludes.Add(LineReplacement.NewLine);
+			Includes.IncludeFileCounts.FindOrAdd(LineReplacement.NewLine)++;
+			Includes.IncludeModuleNames.Add(LineReplacement.NewLine, LineReplacement.ModuleName);
+		}
+	}
+}
+
+FString FModuleBuildSettings::GetPCHFileName(const FString& ModuleName) {
+	return FString::Printf(TEXT("Private/%sPCH.h"), *ModuleName);
+}
+
+void FModuleBuildSettings::GenerateModuleFiles(const FString& ModuleName, const FModuleDependencyGraph& DependencyGraph, TFunctionRef<bool(const FString&)> IsDependencyAvailable, TFunctionRef<bool(const FString&)> IsEngineModule, const FString* ExistingBuildFileContents, FString& OutPCHFileContents, FString& OutBuildFileContents) const {
+	FScopeLock ScopeLock(&ModuleIncludesLock);
+	const FModuleIncludes EmptyIncludes;
+	const FModuleIncludes* Includes = ModuleIncludes.Find(ModuleName);
+	if (Includes == NULL) {
+		Includes = &EmptyIncludes;
+	}
+
+	//Only the engine headers go into the PCH, game headers change too often and would invalidate it on every edit
+	TArray<TPair<FString, int32>> PCHIncludes;
+	for (const TPair<FString, int32>& IncludeFileCount : Includes->IncludeFileCounts) {
+		if (IncludeFileCount.Value >= MinPCHIncludeFileCount && IsEngineModule(Includes->IncludeModuleNames.FindChecked(IncludeFileCount.Key))) {
+			PCHIncludes.Add(IncludeFileCount);
+		}
+	}
+	PCHIncludes.Sort([](const TPair<FString, int32>& A, const TPair<FString, int32>& B) {
+		return A.Value > B.Value || (A.Value == B.Value && A.Key < B.Key);
+	});
+	if (PCHIncludes.Num() > MaxPCHIncludes) {
+		PCHIncludes.SetNum(MaxPCHIncludes);
+	}
+	
+	TArray<FString> PCHFileLines;
+	PCHFileLines.Add(TEXT("#pragma once"));
+	PCHFileLines.Add(TEXT(""));
+	PCHFileLines.Add(TEXT("#include \"CoreMinimal.h\""));
+	for (const TPair<FString, int32>& PCHInclude : PCHIncludes) {
+		PCHFileLines.Add(PCHInclude.Key);
+	}
+	OutPCHFileContents = FString::Join(PCHFileLines, LINE_TERMINATOR) + LINE_TERMINATOR;
+
+	//Build rules of the dump can have the definitions, include paths and the other settings the template knows nothing about
+	if (ExistingBuildFileContents != NULL && UpdateBuildFileForPCH(ModuleName, *ExistingBuildFileContents, DependencyGraph, IsDependencyAvailable, OutBuildFileContents)) {
+		return;
+	}
+
+	TArray<FString> PublicDependencies;
+	TArray<FString> PrivateDependencies;
+	GetModuleDependencies(ModuleName, DependencyGraph, IsDependencyAvailable, PublicDependencies, PrivateDependencies);
+
+	TArray<FString> BuildFileLines;
+	BuildFileLines.Add(TEXT("using UnrealBuildTool;"));
+	BuildFileLines.Add(TEXT(""));
+	BuildFileLines.Add(FString::Printf(TEXT("public class %s : ModuleRules {"), *ModuleName));
+	BuildFileLines.Add(FString::Printf(TEXT("	public %s(ReadOnlyTargetRules Target) : base(Target) {"), *ModuleName));
+	BuildFileLines.Add(TEXT("		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;"));
+	BuildFileLines.Add(FString::Printf(TEXT("		PrivatePCHHeaderFile = \"%s\";"), *GetPCHFileName(ModuleName)));
+	BuildFileLines.Add(TEXT("		bUseUnity = true;"));
+	BuildFileLines.Add(TEXT(""));
+	BuildFileLines.Add(TEXT("		") + MakeDependencyListStatement(TEXT("PublicDependencyModuleNames"), PublicDependencies));
+	if (PrivateDependencies.Num()) {
+		BuildFileLines.Add(TEXT("		") + MakeDependencyListStatement(TEXT("PrivateDependencyModuleNames"), PrivateDependencies));
+	}
+	BuildFileLines.Add(TEXT("	}"));
+	BuildFileLines.Add(TEXT("}"));
+	OutBuildFileContents = FString::Join(BuildFileLines, LINE_TERMINATOR) + LINE_TERMINATOR;
+}
+
+void FModuleBuildSettings::GetModuleDependencies(const FString& ModuleName, const FModuleDependencyGraph& DependencyGraph, TFunctionRef<bool(const FString&)> IsDependencyAvailable, TArray<FString>& OutPublicDependencies, TArray<FString>& OutPrivateDependencies) {
+	TSet<FString> PublicDependencySet;
+	TSet<FString> PrivateDependencySet;
+	DependencyGraph.GetDependencies(ModuleName, PublicDependencySet, PrivateDependencySet);
+
+	//Dependencies are sorted so the build rules do not change between the runs
+	for (const TCHAR* DefaultModuleDependency : DefaultModuleDependencies) {
+		OutPublicDependencies.Add(DefaultModuleDependency);
+	}
+	TArray<FString> ExtraPublicDependencies;
+	for (const FString& DependencyName : PublicDependencySet) {
+		if (!OutPublicDependencies.Contains(DependencyName) && IsDependencyAvailable(DependencyName)) {
+			ExtraPublicDependencies.Add(DependencyName);
+		}
+	}
+	ExtraPublicDependencies.Sort();
+	OutPublicDependencies.Append(ExtraPublicDependencies);
+
+	for (const FString& DependencyName : PrivateDependencySet) {
+		if (!OutPublicDependencies.Contains(DependencyName) && IsDependencyAvailable(DependencyName)) {
+			OutPrivateDependencies.Add(DependencyName);
+		}
+	}
+	OutPrivateDependencies.Sort();
+}
+
+FString FModuleBuildSettings::MakeDependencyListStatement(const TCHAR* ListName, const TArray<FString>& DependencyNames) {
+	TArray<FString> QuotedDependencyNames;
+	for (const FString& DependencyName : DependencyNames) {
+		QuotedDependencyNames.Add(FString::Printf(TEXT("\"%s\""), *DependencyName));
+	}
+	return FString::Printf(TEXT("%s.AddRange(new string[] { %s });"), ListName, *FString::Join(QuotedDependencyNames, TEXT(", ")));
+}
+
+bool FModuleBuildSettings::UpdateBuildFileForPCH(const FString& ModuleName, const FString& BuildFileContents, const FModuleDependencyGraph& DependencyGraph, TFunctionRef<bool(const FString&)> IsDependencyAvailable, FString& OutBuildFileContents) {
+	TArray<FString> InsertedStatements;
+
+	//Rules without any dependency lists get them inserted along with the missing precompiled header settings
+	FString UpdatedBuildFileContents;
+	if (!PruneBuildFileDependencies(ModuleName, BuildFileContents, DependencyGraph, IsDependencyAvailable, UpdatedBuildFileContents)) {
+		UpdatedBuildFileContents = BuildFileContents;
+
+		TArray<FString> PublicDependencies;
+		TArray<FString> PrivateDependencies;
+		GetModuleDependencies(ModuleName, DependencyGraph, IsDependencyAvailable, PublicDependencies, PrivateDependencies);
+		InsertedStatements.Add(MakeDependencyListStatement(TEXT("PublicDependencyModuleNames"), PublicDependencies));
+		if (PrivateDependencies.Num()) {
+			InsertedStatements.Add(MakeDependencyListStatement(TEXT("PrivateDependencyModuleNames"), PrivateDependencies));
+		}
+	}
+
+	const TPair<FString, FString> PCHSettings[] = {
+		TPair<FString, FString>(TEXT("PCHUsage"), TEXT("PCHUsageMode.UseExplicitOrSharedPCHs")),
+		TPair<FString, FString>(TEXT("PrivatePCHHeaderFile"), FString::Printf(TEXT("\"%s\""), *GetPCHFileName(ModuleName)))
+	};
+	TArray<FString> MissingSettingStatements;
+	for (const TPair<FString, FString>& PCHSetting : PCHSettings) {
+		if (!ReplacePropertyAssignment(UpdatedBuildFileContents, PCHSetting.Key, PCHSetting.Value)) {
+			MissingSettingStatements.Add(FString::Printf(TEXT("%s = %s;"), *PCHSetting.Key, *PCHSetting.Value));
+		}
+	}
+	InsertedStatements.Insert(MissingSettingStatements, 0);
+
+	if (InsertedStatements.Num()) {
+		//Missing statements go to the start of the constructor, indented like the line following its opening brace
+		const int32 BaseCallStart = UpdatedBuildFileContents.Find(TEXT(": base("), ESearchCase::CaseSensitive);
+		const int32 BodyStart = BaseCallStart != INDEX_NONE ? UpdatedBuildFileContents.Find(TEXT("{"), ESearchCase::CaseSensitive, ESearchDir::FromStart, BaseCallStart) : INDEX_NONE;
+		const int32 BodyLineEnd = BodyStart != INDEX_NONE ? UpdatedBuildFileContents.Find(TEXT("\n"), ESearchCase::CaseSensitive, ESearchDir::FromStart, BodyStart) : INDEX_NONE;
+		if (BodyLineEnd == INDEX_NONE) {
+			return false;
+		}
+
+		int32 IndentationEnd = BodyLineEnd + 1;
+		while (IndentationEnd < UpdatedBuildFileContents.Len() && (UpdatedBuildFileContents[IndentationEnd] == TEXT(' ') || UpdatedBuildFileContents[IndentationEnd] == TEXT('\t'))) {
+			IndentationEnd++;
+		}
+		FString StatementIndentation = UpdatedBuildFileContents.Mid(BodyLineEnd + 1, IndentationEnd - BodyLineEnd - 1);
+		if (StatementIndentation.IsEmpty()) {
+			StatementIndentation = TEXT("\t\t");
+		}
+
+		FString InsertedText;
+		for (const FString& InsertedStatement : InsertedStatements) {
+			InsertedText += StatementIndentation + InsertedStatement + LINE_TERMINATOR;
+		}
+		UpdatedBuildFileContents.InsertAt(BodyLineEnd + 1, InsertedText);
+	}
+	OutBuildFileContents = MoveTemp(UpdatedBuildFileContents);
+	return true;
+}
+
+bool FModuleBuildSettings::ReplacePropertyAssignment(FString& BuildFileContents, const FString& PropertyName, const FString& NewValue) {
+	int32 SearchStart = 0;
+	int32 NameStart;
+
+	while ((NameStart = BuildFileContents.Find(PropertyName, ESearchCase::CaseSensitive, ESearchDir::FromStart, SearchStart)) != INDEX_NONE) {
+		SearchStart = NameStart + PropertyName.Len();
+
+		//Only the assignments count, not the longer names starting the same way like PCHUsageMode, nor the comparisons
+		const bool bIsPartOfLongerName = NameStart > 0 && (FChar::IsAlnum(BuildFileContents[NameStart - 1]) || BuildFileContents[NameStart - 1] == TEXT('_'));
+		int32 OperatorStart = SearchStart;
+		while (OperatorStart < BuildFileContents.Len() && FChar::IsWhitespace(BuildFileContents[OperatorStart])) {
+			OperatorStart++;
+		}
+		const bool bIsAssignment = OperatorStart < BuildFileContents.Len() && BuildFileContents[OperatorStart] == TEXT('=') &&
+			(OperatorStart + 1 >= BuildFileContents.Len() || BuildFileContents[OperatorStart + 1] != TEXT('='));
+		if (bIsPartOfLongerName || !bIsAssignment) {
+			continue;
+		}
+
+		const int32 StatementEnd = BuildFileContents.Find(TEXT(";"), ESearchCase::CaseSensitive, ESearchDir::FromStart, OperatorStart);
+		if (StatementEnd == INDEX_NONE) {
+			return false;
+		}
+		BuildFileContents = BuildFileContents.Left(NameStart) + PropertyName + TEXT(" = ") + NewValue + BuildFileContents.Mid(StatementEnd);
+		return true;
+	}
+	return false;
+}
+
+void FModuleBuildSettings::ParseBuildFileDependencies(const FString& BuildFileContents, TArray<FString>& OutModuleNames) {
+	//UBT fails on any module referenced by these lists that does not exist, not only on the dependencies
+	static const TCHAR* ModuleListNames[] = {TEXT("PublicDependencyModuleNames"), TEXT("PrivateDependencyModuleNames"), TEXT("PublicIncludePathModuleNames"),
+		TEXT("PrivateIncludePathModuleNames"), TEXT("DynamicallyLoadedModuleNames")};
+
+	for (const TCHAR* ModuleListName : ModuleListNames) {
+		int32 SearchStart = 0;
+		int32 ListNameStart;
+
+		while ((ListNameStart = BuildFileContents.Find(ModuleListName, ESearchCase::CaseSensitive, ESearchDir::FromStart, SearchStart)) != INDEX_NONE) {
+			const int32 StatementEnd = BuildFileContents.Find(TEXT(";"), ESearchCase::CaseSensitive, ESearchDir::FromStart, ListNameStart);
+			if (StatementEnd == INDEX_NONE) {
+				break;
+			}
+
+			//Every string literal of the statement is the name of the module
+			int32 LiteralStart = BuildFileContents.Find(TEXT("\""), ESearchCase::CaseSensitive, ESearchDir::FromStart, ListNameStart);
+			while (LiteralStart != INDEX_NONE && LiteralStart < StatementEnd) {
+				const int32 LiteralEnd = BuildFileContents.Find(TEXT("\""), ESearchCase::CaseSensitive, ESearchDir::FromStart, LiteralStart + 1);
+				if (LiteralEnd == INDEX_NONE || LiteralEnd > StatementEnd) {
+					break;
+				}
+				const FString ModuleName = BuildFileContents.Mid(LiteralStart + 1, LiteralEnd - LiteralStart - 1);
+				if (!ModuleName.IsEmpty()) {
+					OutModuleNames.AddUnique(ModuleName);
+				}
+				LiteralStart = BuildFileContents.Find(TEXT("\""), ESearchCase::CaseSensitive, ESearchDir::FromStart, LiteralEnd + 1);
+			}
+			SearchStart = StatementEnd + 1;
+		}
+	}
+}
+
+bool FModuleBuildSettings::PruneBuildFileDependencies(const FString& ModuleName, const FString& BuildFileContents, const FModuleDependencyGraph& DependencyGraph, TFunctionRef<bool(const FString&)> IsDependencyAvailable, FString& OutBuildFileContents) {
+	static const TCHAR* DependencyListNames[] = {TEXT("PublicDependencyModuleNames"), TEXT("PrivateDependencyModuleNames")};
+
+	//Every statement adding to the dependency lists is removed, and the new lists are put where the first one of them has been
+	OutBuildFileContents = BuildFileContents;
+	int32 FirstStatementStart = INDEX_NONE;
+	FString StatementIndentation;
+
+	for (const TCHAR* DependencyListName : DependencyListNames) {
+		int32 SearchStart = 0;
+		int32 ListNameStart;
+		
+		while ((ListNameStart = OutBuildFileContents.Find(DependencyListName, ESearchCase::CaseSensitive, ESearchDir::FromStart, SearchStart)) != INDEX_NONE) {
+			const int32 StatementEnd = OutBuildFileContents.Find(TEXT(";"), ESearchCase::CaseSensitive, ESearchDir::FromStart, ListNameStart);
+			if (StatementEnd == INDEX_NONE) {
+				return false;
+			}
+
+			//Whole lines are removed along with their indentation, unless the statement shares the line with something else
+			int32 RemoveStart = ListNameStart;
+			while (RemoveStart > 0 && (OutBuildFileContents[RemoveStart - 1] == TEXT(' ') || OutBuildFileContents[RemoveStart - 1] == TEXT('\t'))) {
+				RemoveStart--;
+			}
+			int32 RemoveEnd = StatementEnd + 1;
+			if (RemoveStart == 0 || OutBuildFileContents[RemoveStart - 1] == TEXT('\n')) {
+				while (RemoveEnd < OutBuildFileContents.Len() && OutBuildFileContents[RemoveEnd] != TEXT('\n')) {
+					RemoveEnd++;
+				}
+				RemoveEnd = FMath::Min(RemoveEnd + 1, OutBuildFileContents.Len());
+			} else {
+				RemoveStart = ListNameStart;
+			}
+
+			if (FirstStatementStart == INDEX_NONE || RemoveStart < FirstStatementStart) {
+				FirstStatementStart = RemoveStart;
+				StatementIndentation = OutBuildFileContents.Mid(RemoveStart, ListNameStart - RemoveStart);
+			}
+			OutBuildFileContents.RemoveAt(RemoveStart, RemoveEnd - RemoveStart, false);
+			SearchStart = RemoveStart;
+		}
+	}
+
+	if (FirstStatementStart == INDEX_NONE) {
+		return false;
+	}
+
+	TArray<FString> PublicDependencies;
+	TArray<FString> PrivateDependencies;
+	GetModuleDependencies(ModuleName, DependencyGraph, IsDependencyAvailable, PublicDependencies, PrivateDependencies);
+
+	FString DependencyStatements = StatementIndentation + MakeDependencyListStatement(DependencyListNames[0], PublicDependencies) + LINE_TERMINATOR;
+	if (PrivateDependencies.Num()) {
+		DependencyStatements += StatementIndentation + MakeDependencyListStatement(DependencyListNames[1], PrivateDependencies) + LINE_TERMINATOR;
+	}
+	OutBuildFileContents.InsertAt(FirstStatementStart, DependencyStatements);
+	return true;
+}
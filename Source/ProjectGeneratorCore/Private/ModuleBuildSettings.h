@@ -0,0 +1,49 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "HeaderFileRewriter.h"
+
+class FModuleDependencyGraph;
+
+/**
+ * Collects the includes resolved for the files of every generated module, and produces a shared precompiled header
+ * and the build rules depending only on the modules the files actually include
+ */
+class FModuleBuildSettings {
+public:
+	/** Records the includes resolved for a single file of the module. Thread safe */
+	void AddFileIncludes(const FString& ModuleName, const TArray<FHeaderLineReplacement>& LineReplacements);
+
+	/**
+	 * Generates the precompiled header out of the engine includes used by the most of the module files, and the build rules using it
+	 * Existing build rules of the dump are kept with only their precompiled header settings and dependency lists replaced, new ones are only generated when there are none
+	 * Only the modules accepted by the predicate are added as the dependencies, engine includes are the ones belonging to the engine modules
+	 */
+	void GenerateModuleFiles(const FString& ModuleName, const FModuleDependencyGraph& DependencyGraph, TFunctionRef<bool(const FString&)> IsDependencyAvailable, TFunctionRef<bool(const FString&)> IsEngineModule, const FString* ExistingBuildFileContents, FString& OutPCHFileContents, FString& OutBuildFileContents) const;
+
+	/** Replaces the dependency module lists of the existing build rules with the modules referenced according to the graph. Returns false if the rules do not declare any */
+	static bool PruneBuildFileDependencies(const FString& ModuleName, const FString& BuildFileContents, const FModuleDependencyGraph& DependencyGraph, TFunctionRef<bool(const FString&)> IsDependencyAvailable, FString& OutBuildFileContents);
+
+	/** Collects the modules referenced by the dependency, include path and dynamically loaded module lists of the build rules */
+	static void ParseBuildFileDependencies(const FString& BuildFileContents, TArray<FString>& OutModuleNames);
+
+	/** Path of the generated precompiled header relative to the module directory */
+	static FString GetPCHFileName(const FString& ModuleName);
+private:
+	/** Dependencies of the module according to the graph, sorted and limited to the available modules, starting with the ones every module needs */
+	static void GetModuleDependencies(const FString& ModuleName, const FModuleDependencyGraph& DependencyGraph, TFunctionRef<bool(const FString&)> IsDependencyAvailable, TArray<FString>& OutPublicDependencies, TArray<FString>& OutPrivateDependencies);
+	static FString MakeDependencyListStatement(const TCHAR* ListName, const TArray<FString>& DependencyNames);
+
+	/** Points the existing build rules at the generated precompiled header and replaces their dependency lists. Returns false if the constructor of the rules cannot be found */
+	static bool UpdateBuildFileForPCH(const FString& ModuleName, const FString& BuildFileContents, const FModuleDependencyGraph& DependencyGraph, TFunctionRef<bool(const FString&)> IsDependencyAvailable, FString& OutBuildFileContents);
+
+	/** Replaces the value assigned to the property of the rules, returns false if the rules do not assign it */
+	static bool ReplacePropertyAssignment(FString& BuildFileContents, const FString& PropertyName, const FString& NewValue);
+
+	struct FModuleIncludes {
+		/** Number of files including the header and the module it belongs to, keyed by the include line */
+		TMap<FString, int32> IncludeFileCounts;
+		TMap<FString, FString> IncludeModuleNames;
+	};
+	TMap<FString, FModuleIncludes> ModuleIncludes;
+	mutable FCriticalSection ModuleIncludesLock;
+};
@@ -0,0 +1,211 @@
+#include "ModuleDependencyGraph.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+
+void FModuleDependencyGraph::AddFileIncludes(const FString& ModuleName, bool bIsPublicHeader, const TArray<FHeaderLineReplacement>& LineReplacements) {
+	FScopeLock ScopeLock(&ModuleEdgesLock);
+	TMap<FString, FModuleEdge>& Edges = ModuleEdges.FindOrAdd(ModuleName);
+
+	for (const FHeaderLineReplacement& LineReplacement : LineReplacements) {
+		//Includes of the module's own headers and the forward declarations do not make a dependency
+		if (LineReplacement.ModuleName.IsEmpty() || LineReplacement.ModuleName == ModuleName) {
+			continue;
+		}
+		FModuleEdge& Edge = Edges.FindOrAdd(LineReplacement.ModuleName);
+		(bIsPublicHeader ? Edge.PublicReferences : Edge.PrivateReferences)++;
+	}
+}
+
+void FModuleDependencyGraph::GetDependencies(const FString& ModuleName, TSet<FString>& OutPublicDependencies, TSet<FString>& OutPrivateDependencies) const {
+	FScopeLock ScopeLock(&ModuleEdgesLock);
+	if (const TMap<FString, FModuleEdge>* Edges = ModuleEdges.Find(ModuleName)) {
+		for (const TPair<FString, FModuleEdge>& Edge : *Edges) {
+			(Edge.Value.PublicReferences ? OutPublicDependencies : OutPrivateDependencies).Add(Edge.Key);
+		}
+	}
+}
+
+TArray<TArray<FString>> FModuleDependencyGraph::FindCycles(TFunctionRef<bool(const FString&)> IsGraphModule) const {
+	FScopeLock ScopeLock(&ModuleEdgesLock);
+
+	//Modules and their edges are sorted first, so the cycles are reported the same way on every run
+	TArray<FString> ModuleNames;
+	for (const TPair<FString, TMap<FString, FModuleEdge>>& Module : ModuleEdges) {
+		if (IsGraphModule(Module.Key)) {
+			ModuleNames.Add(Module.Key);
+		}
+	}
+	ModuleNames.Sort();
+
+	TMap<FString, int32> ModuleIndices;
+	for (int32 ModuleIndex = 0; ModuleIndex < ModuleNames.Num(); ModuleIndex++) {
+		ModuleIndices.Add(ModuleNames[ModuleIndex], ModuleIndex);
+	}
+
+	TArray<TArray<int32>> Successors;
+	Successors.SetNum(ModuleNames.Num());
+	for (int32 ModuleIndex = 0; ModuleIndex < ModuleNames.Num(); ModuleIndex++) {
+		for (const TPair<FString, FModuleEdge>& Edge : ModuleEdges.FindChecked(ModuleNames[ModuleIndex])) {
+			if (const int32* SuccessorIndex = ModuleIndices.Find(Edge.Key)) {
+				Successors[ModuleIndex].Add(*SuccessorIndex);
+			}
+		}
+		Successors[ModuleIndex].Sort();
+	}
+
+	//Tarjan's strongly connected components, with an explicit stack so deep dependency chains do not overflow the thread stack
+	TArray<int32> DiscoveryIndices;
+	TArray<int32> LowLinks;
+	TArray<bool> OnStack;
+	DiscoveryIndices.Init(INDEX_NONE, ModuleNames.Num());
+	LowLinks.Init(0, ModuleNames.Num());
+	OnStack.Init(false, ModuleNames.Num());
+
+	TArray<int32> ComponentStack;
+	TArray<TPair<int32, int32>> CallStack;
+	TArray<TArray<FString>> Cycles;
+	int32 NextDiscoveryIndex = 0;
+
+	for (int32 RootIndex = 0; RootIndex < ModuleNames.Num(); RootIndex++) {
+		if (DiscoveryIndices[RootIndex] != INDEX_NONE) {
+			continue;
+		}
+		CallStack.Add(TPair<int32, int32>(RootIndex, 0));
+
+		while (CallStack.Num()) {
+			const int32 ModuleIndex = CallStack.Last().Key;
+			int32& NextSuccessor = CallStack.Last().Value;
+
+			if (NextSuccessor == 0 && DiscoveryIndices[ModuleIndex] == INDEX_NONE) {
+				DiscoveryIndices[ModuleIndex] = LowLinks[ModuleIndex] = NextDiscoveryIndex++;
+				ComponentStack.Add(ModuleIndex);
+				OnStack[ModuleIndex] = true;
+			}
+
+			if (NextSuccessor < Successors[ModuleIndex].Num()) {
+				const int32 SuccessorIndex = Successors[ModuleIndex][NextSuccessor++];
+				if (DiscoveryIndices[SuccessorIndex] == INDEX_NONE) {
+					CallStack.Add(TPair<int32, int32>(SuccessorIndex, 0));
+				} else if (OnStack[SuccessorIndex]) {
+					LowLinks[ModuleIndex] = FMath::Min(LowLinks[ModuleIndex], DiscoveryIndices[SuccessorIndex]);
+				}
+				continue;
+			}
+
+			//All of the successors have been visited, pop the component if this module is its root
+			if (LowLinks[ModuleIndex] == DiscoveryIndices[ModuleIndex]) {
+				TArray<FString> Component;
+				int32 ComponentModuleIndex;
+				do {
+					ComponentModuleIndex = ComponentStack.Pop(false);
+					OnStack[ComponentModuleIndex] = false;
+					Component.Add(ModuleNames[ComponentModuleIndex]);
+				} while (ComponentModuleIndex != ModuleIndex);
+
+				if (Component.Num() > 1) {
+					Component.Sort();
+					Cycles.Add(MoveTemp(Component));
+				}
+			}
+			CallStack.Pop(false);
+			if (CallStack.Num()) {
+				const int32 ParentIndex = CallStack.Last().Key;
+				LowLinks[ParentIndex] = FMath::Min(LowLinks[ParentIndex], LowLinks[ModuleIndex]);
+			}
+		}
+	}
+
+	Cycles.Sort([](const TArray<FString>& A, const TArray<FString>& B) {
+		return A[0] < B[0];
+	});
+	return Cycles;
+}
+
+bool FModuleDependencyGraph::Save(const FString& Filename, const TArray<TArray<FString>>& Cycles) const {
+	const FString GraphContents = FPaths::GetExtension(Filename) == TEXT("dot") ? ToDotString(Cycles) : ToJsonString(Cycles);
+	return FFileHelper::SaveStringToFile(GraphContents, *Filename);
+}
+
+FString FModuleDependencyGraph::ToDotString(const TArray<TArray<FString>>& Cycles) const {
+	FScopeLock ScopeLock(&ModuleEdgesLock);
+
+	TSet<FString> CycleModules;
+	for (const TArray<FString>& Cycle : Cycles) {
+		CycleModules.Append(Cycle);
+	}
+
+	TArray<FString> ModuleNames;
+	ModuleEdges.GetKeys(ModuleNames);
+	ModuleNames.Sort();
+
+	//Private dependencies are dashed, and the modules that are a part of the cycle are highlighted
+	TArray<FString> GraphLines;
+	GraphLines.Add(TEXT("digraph ModuleDependencies {"));
+	for (const FString& ModuleName : ModuleNames) {
+		if (CycleModules.Contains(ModuleName)) {
+			GraphLines.Add(FString::Printf(TEXT("\t\"%s\" [color=red];"), *ModuleName));
+		}
+
+		TArray<FString> DependencyNames;
+		ModuleEdges.FindChecked(ModuleName).GetKeys(DependencyNames);
+		DependencyNames.Sort();
+
+		for (const FString& DependencyName : DependencyNames) {
+			const FModuleEdge& Edge = ModuleEdges.FindChecked(ModuleName).FindChecked(DependencyName);
+			GraphLines.Add(FString::Printf(TEXT("\t\"%s\" -> \"%s\" [label=%d%s];"), *ModuleName, *DependencyName,
+				Edge.PublicReferences + Edge.PrivateReferences, Edge.PublicReferences ? TEXT("") : TEXT(", style=dashed")));
+		}
+	}
+	GraphLines.Add(TEXT("}"));
+	return FString::Join(GraphLines, LINE_TERMINATOR) + LINE_TERMINATOR;
+}
+
+FString FModuleDependencyGraph::ToJsonString(const TArray<TArray<FString>>& Cycles) const {
+	FScopeLock ScopeLock(&ModuleEdgesLock);
+
+	TArray<FString> ModuleNames;
+	ModuleEdges.GetKeys(ModuleNames);
+	ModuleNames.Sort();
+
+	const TSharedRef<FJsonObject> ModulesObject = MakeShareable(new FJsonObject());
+	for (const FString& ModuleName : ModuleNames) {
+		TArray<FString> DependencyNames;
+		ModuleEdges.FindChecked(ModuleName).GetKeys(DependencyNames);
+		DependencyNames.Sort();
+
+		const TSharedRef<FJsonObject> PublicObject = MakeShareable(new FJsonObject());
+		const TSharedRef<FJsonObject> PrivateObject = MakeShareable(new FJsonObject());
+		for (const FString& DependencyName : DependencyNames) {
+			const FModuleEdge& Edge = ModuleEdges.FindChecked(ModuleName).FindChecked(DependencyName);
+			if (Edge.PublicReferences) {
+				PublicObject->SetNumberField(DependencyName, Edge.PublicReferences + Edge.PrivateReferences);
+			} else {
+				PrivateObject->SetNumberField(DependencyName, Edge.PrivateReferences);
+			}
+		}
+
+		const TSharedRef<FJsonObject> ModuleObject = MakeShareable(new FJsonObject());
+		ModuleObject->SetObjectField(TEXT("Public"), PublicObject);
+		ModuleObject->SetObjectField(TEXT("Private"), PrivateObject);
+		ModulesObject->SetObjectField(ModuleName, ModuleObject);
+	}
+
+	TArray<TSharedPtr<FJsonValue>> CyclesArray;
+	for (const TArray<FString>& Cycle : Cycles) {
+		TArray<TSharedPtr<FJsonValue>> CycleArray;
+		for (const FString& ModuleName : Cycle) {
+			CycleArray.Add(MakeShareable(new FJsonValueString(ModuleName)));
+		}
+		CyclesArray.Add(MakeShareable(new FJsonValueArray(CycleArray)));
+	}
+
+	const TSharedRef<FJsonObject> GraphObject = MakeShareable(new FJsonObject());
+	GraphObject->SetObjectField(TEXT("Modules"), ModulesObject);
+	GraphObject->SetArrayField(TEXT("Cycles"), CyclesArray);
+
+	FString GraphContents;
+	const TSharedRef<TJsonWriter<>> GraphWriter = TJsonWriterFactory<>::Create(&GraphContents);
+	FJsonSerializer::Serialize(GraphObject, GraphWriter);
+	return GraphContents;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "HeaderFileRewriter.h"
+
+/**
+ * Module to module dependencies collected from the resolved cross module includes
+ * Every edge remembers how many includes of the public headers and of the rest of the files it is made of
+ */
+class FModuleDependencyGraph {
+public:
+	/** Records the includes resolved for a single file of the module. Includes of the public headers make public dependencies. Thread safe */
+	void AddFileIncludes(const FString& ModuleName, bool bIsPublicHeader, const TArray<FHeaderLineReplacement>& LineReplacements);
+
+	/** Retrieves the modules referenced by the public headers of the module and the ones referenced only by the rest of its files */
+	void GetDependencies(const FString& ModuleName, TSet<FString>& OutPublicDependencies, TSet<FString>& OutPrivateDependencies) const;
+
+	/** Finds the groups of modules accepted by the predicate that depend on each other. Every group is sorted, and so are the groups themselves */
+	TArray<TArray<FString>> FindCycles(TFunctionRef<bool(const FString&)> IsGraphModule) const;
+
+	/** Saves the graph together with its cycles, as Graphviz DOT when the file has the .dot extension and as JSON otherwise */
+	bool Save(const FString& Filename, const TArray<TArray<FString>>& Cycles) const;
+private:
+	struct FModuleEdge {
+		int32 PublicReferences = 0;
+		int32 PrivateReferences = 0;
+	};
+	FString ToDotString(const TArray<TArray<FString>>& Cycles) const;
+	FString ToJsonString(const TArray<TArray<FString>>& Cycles) const;
+
+	TMap<FString, TMap<FString, FModuleEdge>> ModuleEdges;
+	mutable FCriticalSection ModuleEdgesLock;
+};
@@ -0,0 +1,77 @@
+#include "ModuleSelection.h"
+#include "ProjectGenerator.h"
+#include "HeaderFileRewriter.h"
+#include "ModuleBuildSettings.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+
+TSet<FString> FModuleSelection::ComputeClosure(const FString& HeaderRoot, const TArray<FString>& RequestedModules, TFunctionRef<bool(const FString&)> IsEngineModule, int32 NumThreads) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TSet<FString> SelectedModules;
+	TArray<FString> PendingModules;
+
+	for (const FString& RequestedModule : RequestedModules) {
+		if (!PlatformFile.DirectoryExists(*(HeaderRoot / RequestedModule))) {
+			UE_LOG(LogProjectGenerator, Warning, TEXT("Requested module %s does not exist in the header dump"), *RequestedModule);
+		}
+		if (!SelectedModules.Contains(RequestedModule)) {
+			SelectedModules.Add(RequestedModule);
+			PendingModules.Add(RequestedModule);
+		}
+	}
+
+	//Modules are scanned breadth first, with the files of all modules found at the same depth read in parallel
+	while (PendingModules.Num()) {
+		TArray<FString> ModuleFiles;
+		TArray<FString> BuildFileReferencedModules;
+		TFunction<bool(const TCHAR*, bool)> CollectModuleFiles = [&](const TCHAR* Filename, bool bIsDirectory) {
+			const FString FileExtension = FPaths::GetExtension(Filename);
+			if (!bIsDirectory && (FileExtension == TEXT("h") || FileExtension == TEXT("cpp"))) {
+				ModuleFiles.Add(Filename);
+			}
+			return true;
+		};
+		for (const FString& ModuleName : PendingModules) {
+			if (!IsEngineModule(ModuleName)) {
+				PlatformFile.IterateDirectoryRecursively(*(HeaderRoot / ModuleName), CollectModuleFiles);
+
+				//Build rules can depend on the modules none of the files include, and UBT refuses to build the project when any of them is missing
+				FString BuildFileContents;
+				if (FFileHelper::LoadFileToString(BuildFileContents, *(HeaderRoot / ModuleName / ModuleName + TEXT(".Build.cs")))) {
+					FModuleBuildSettings::ParseBuildFileDependencies(BuildFileContents, BuildFileReferencedModules);
+				}
+			}
+		}
+
+		TArray<TArray<FString>> FileReferencedModules;
+		FileReferencedModules.SetNum(ModuleFiles.Num());
+
+		ParallelFor(ModuleFiles.Num(), [&](int32 FileIndex) {
+			TArray<uint8> FileContents;
+			if (!FHeaderFileRewriter::LoadFileContents(ModuleFiles[FileIndex], FileContents)) {
+				UE_LOG(LogProjectGenerator, Error, TEXT("Failed to read module file %s"), *ModuleFiles[FileIndex]);
+				return;
+			}
+			TArray<FHeaderIncludeMarker> IncludeMarkers;
+			FHeaderFileRewriter::FindIncludeMarkers(ModuleFiles[FileIndex], FileContents, IncludeMarkers);
+
+			for (const FHeaderIncludeMarker& IncludeMarker : IncludeMarkers) {
+				FileReferencedModules[FileIndex].AddUnique(IncludeMarker.IncludeKey.ModuleName);
+			}
+		}, NumThreads <= 1);
+
+		//Merged in the file order, so the modules are always discovered in the same order
+		PendingModules.Reset();
+		FileReferencedModules.Add(MoveTemp(BuildFileReferencedModules));
+		for (const TArray<FString>& ReferencedModules : FileReferencedModules) {
+			for (const FString& ReferencedModule : ReferencedModules) {
+				if (!SelectedModules.Contains(ReferencedModule)) {
+					SelectedModules.Add(ReferencedModule);
+					PendingModules.Add(ReferencedModule);
+				}
+			}
+		}
+	}
+	return SelectedModules;
+}
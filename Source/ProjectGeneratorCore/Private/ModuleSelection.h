@@ -0,0 +1,13 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Selects the subset of the header dump modules to generate, starting from the requested modules and following the cross module include markers of their files
+ * and the modules referenced by their build rules transitively
+ * Engine modules end up in the selection when they are included, but are never scanned, since they cannot include the game modules
+ */
+class FModuleSelection {
+public:
+	/** Returns the requested modules along with all of the modules their files include or their build rules reference, directly or indirectly */
+	static TSet<FString> ComputeClosure(const FString& HeaderRoot, const TArray<FString>& RequestedModules, TFunctionRef<bool(const FString&)> IsEngineModule, int32 NumThreads);
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+
+/**
+ * Walks the directory tree breadth first, visiting all of the directories at the same depth in parallel
+ * Visitor is called from the worker threads and returns the sub-directories to descend into along with the results for the directory,
+ * which are merged on the calling thread in the same order as the directories, so the walk result does not depend on scheduling
+ */
+template<typename ResultType>
+void WalkDirectoryTreeParallel(const FString& RootDirectory, TFunctionRef<void(const FString& Directory, TArray<FString>& OutSubDirectories, ResultType& OutResult)> DirectoryVisitor, TFunctionRef<void(ResultType& Result)> ResultMerger) {
+	TArray<FString> CurrentLevelDirectories;
+	CurrentLevelDirectories.Add(RootDirectory);
+
+	while (CurrentLevelDirectories.Num()) {
+		TArray<TArray<FString>> SubDirectories;
+		TArray<ResultType> DirectoryResults;
+		SubDirectories.SetNum(CurrentLevelDirectories.Num());
+		DirectoryResults.SetNum(CurrentLevelDirectories.Num());
+
+		ParallelFor(CurrentLevelDirectories.Num(), [&](int32 DirectoryIndex) {
+			DirectoryVisitor(CurrentLevelDirectories[DirectoryIndex], SubDirectories[DirectoryIndex], DirectoryResults[DirectoryIndex]);
+		});
+
+		TArray<FString> NextLevelDirectories;
+		for (int32 DirectoryIndex = 0; DirectoryIndex < CurrentLevelDirectories.Num(); DirectoryIndex++) {
+			ResultMerger(DirectoryResults[DirectoryIndex]);
+			NextLevelDirectories.Append(MoveTemp(SubDirectories[DirectoryIndex]));
+		}
+		CurrentLevelDirectories = MoveTemp(NextLevelDirectories);
+	}
+}
@@ -0,0 +1,134 @@
+#include "ProjectGenerationPlan.h"
+#include "PluginDescriptor.h"
+#include "ProjectDescriptor.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+
+template<typename DescriptorType>
+static void FillDescriptorLists(const DescriptorType& Descriptor, TArray<FString>& OutModuleNames, TArray<FString>& OutPluginNames) {
+	for (const FModuleDescriptor& ModuleDescriptor : Descriptor.Modules) {
+		OutModuleNames.Add(ModuleDescriptor.Name.ToString());
+	}
+	for (const FPluginReferenceDescriptor& PluginReference : Descriptor.Plugins) {
+		OutPluginNames.Add(PluginReference.Name);
+	}
+}
+
+void FProjectGenerationPlan::AddModule(const FString& ModuleName, EModuleClassification Classification, const FString& OwnerPluginName, const FString& TargetDirectory, int32 NumFiles) {
+	Modules.Add(FModuleEntry{ModuleName, Classification, OwnerPluginName, TargetDirectory, NumFiles});
+}
+
+void FProjectGenerationPlan::AddPluginDescriptor(const FString& PluginName, const FString& PluginFilePath, const FPluginDescriptor& PluginDescriptor) {
+	FDescriptorEntry& PluginEntry = Plugins.AddDefaulted_GetRef();
+	PluginEntry.Name = PluginName;
+	PluginEntry.FilePath = PluginFilePath;
+	FillDescriptorLists(PluginDescriptor, PluginEntry.ModuleNames, PluginEntry.PluginNames);
+}
+
+void FProjectGenerationPlan::SetProjectDescriptor(const FString& ProjectFilePath, const FProjectDescriptor& ProjectDescriptor) {
+	Project = FDescriptorEntry{};
+	Project.Name = FPaths::GetBaseFilename(ProjectFilePath);
+	Project.FilePath = ProjectFilePath;
+	FillDescriptorLists(ProjectDescriptor, Project.ModuleNames, Project.PluginNames);
+}
+
+void FProjectGenerationPlan::SetTargetModules(const FString& TargetFilePath, const TSet<FString>& TargetModuleNames) {
+	Target = FDescriptorEntry{};
+	Target.Name = FPaths::GetBaseFilename(TargetFilePath);
+	Target.FilePath = TargetFilePath;
+	Target.ModuleNames = TargetModuleNames.Array();
+	Target.ModuleNames.Sort();
+}
+
+int32 FProjectGenerationPlan::GetNumModules(EModuleClassification Classification) const {
+	int32 NumModules = 0;
+	for (const FModuleEntry& ModuleEntry : Modules) {
+		if (ModuleEntry.Classification == Classification) {
+			NumModules++;
+		}
+	}
+	return NumModules;
+}
+
+const TCHAR* FProjectGenerationPlan::LexToString(EModuleClassification Classification) {
+	switch (Classification) {
+		case EModuleClassification::PluginModule: return TEXT("Plugin");
+		case EModuleClassification::GameModule: return TEXT("Game");
+		case EModuleClassification::ForcedGameModule: return TEXT("ForcedGame");
+		case EModuleClassification::EngineModule: return TEXT("EngineSkipped");
+		case EModuleClassification::EnginePluginModule: return TEXT("EnginePluginSkipped");
+		case EModuleClassification::DiscardedModule: return TEXT("Discarded");
+		case EModuleClassification::UnselectedModule: return TEXT("Unselected");
+	}
+	return TEXT("Unknown");
+}
+
+static TArray<TSharedPtr<FJsonValue>> MakeStringArray(const TArray<FString>& Strings) {
+	TArray<TSharedPtr<FJsonValue>> ResultArray;
+	for (const FString& String : Strings) {
+		ResultArray.Add(MakeShareable(new FJsonValueString(String)));
+	}
+	return ResultArray;
+}
+
+static TSharedRef<FJsonObject> MakeDescriptorObject(const FString& FilePath, const TArray<FString>& ModuleNames, const TArray<FString>& PluginNames) {
+	const TSharedRef<FJsonObject> DescriptorObject = MakeShareable(new FJsonObject());
+	DescriptorObject->SetStringField(TEXT("File"), FilePath);
+	DescriptorObject->SetArrayField(TEXT("Modules"), MakeStringArray(ModuleNames));
+	DescriptorObject->SetArrayField(TEXT("Plugins"), MakeStringArray(PluginNames));
+	return DescriptorObject;
+}
+
+FString FProjectGenerationPlan::ToJsonString() const {
+	//Modules are sorted by name, so the plans for two header dumps can be compared with a plain diff
+	TArray<FModuleEntry> SortedModules = Modules;
+	SortedModules.Sort([](const FModuleEntry& A, const FModuleEntry& B) {
+		return A.ModuleName < B.ModuleName;
+	});
+
+	TArray<TSharedPtr<FJsonValue>> ModulesArray;
+	for (const FModuleEntry& ModuleEntry : SortedModules) {
+		const TSharedRef<FJsonObject> ModuleObject = MakeShareable(new FJsonObject());
+		ModuleObject->SetStringField(TEXT("Name"), ModuleEntry.ModuleName);
+		ModuleObject->SetStringField(TEXT("Classification"), LexToString(ModuleEntry.Classification));
+		if (!ModuleEntry.OwnerPluginName.IsEmpty()) {
+			ModuleObject->SetStringField(TEXT("Plugin"), ModuleEntry.OwnerPluginName);
+		}
+		if (!ModuleEntry.TargetDirectory.IsEmpty()) {
+			ModuleObject->SetStringField(TEXT("TargetDirectory"), ModuleEntry.TargetDirectory);
+			ModuleObject->SetNumberField(TEXT("NumFiles"), ModuleEntry.NumFiles);
+		}
+		ModulesArray.Add(MakeShareable(new FJsonValueObject(ModuleObject)));
+	}
+
+	TArray<FDescriptorEntry> SortedPlugins = Plugins;
+	SortedPlugins.Sort([](const FDescriptorEntry& A, const FDescriptorEntry& B) {
+		return A.Name < B.Name;
+	});
+
+	const TSharedRef<FJsonObject> PluginsObject = MakeShareable(new FJsonObject());
+	for (const FDescriptorEntry& PluginEntry : SortedPlugins) {
+		PluginsObject->SetObjectField(PluginEntry.Name, MakeDescriptorObject(PluginEntry.FilePath, PluginEntry.ModuleNames, PluginEntry.PluginNames));
+	}
+
+	const TSharedRef<FJsonObject> TargetObject = MakeShareable(new FJsonObject());
+	TargetObject->SetStringField(TEXT("File"), Target.FilePath);
+	TargetObject->SetArrayField(TEXT("Modules"), MakeStringArray(Target.ModuleNames));
+
+	const TSharedRef<FJsonObject> PlanObject = MakeShareable(new FJsonObject());
+	PlanObject->SetNumberField(TEXT("Version"), 1);
+	PlanObject->SetArrayField(TEXT("Modules"), ModulesArray);
+	PlanObject->SetObjectField(TEXT("Plugins"), PluginsObject);
+	PlanObject->SetObjectField(TEXT("Project"), MakeDescriptorObject(Project.FilePath, Project.ModuleNames, Project.PluginNames));
+	PlanObject->SetObjectField(TEXT("Target"), TargetObject);
+
+	FString PlanString;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&PlanString);
+	FJsonSerializer::Serialize(PlanObject, JsonWriter);
+	return PlanString;
+}
+
+bool FProjectGenerationPlan::Save(const FString& PlanFilePath) const {
+	return FFileHelper::SaveStringToFile(ToJsonString(), *PlanFilePath);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FPluginDescriptor;
+struct FProjectDescriptor;
+
+/** How the module found inside of the header dump has been handled */
+enum class EModuleClassification : uint8 {
+	/** Module belongs to the game plugin and is generated inside of it */
+	PluginModule,
+	/** Module is listed in the project file and generated inside of the project source directory */
+	GameModule,
+	/** Module is not known to the engine, plugins or the project file, but is still generated as a game module */
+	ForcedGameModule,
+	/** Module exists inside of the engine and is skipped */
+	EngineModule,
+	/** Module belongs to one of the engine plugins and is skipped */
+	EnginePluginModule,
+	/** Module belongs to the plugin with unknown location and is skipped */
+	DiscardedModule,
+	/** Module is not included by any of the modules requested with -Modules and is skipped */
+	UnselectedModule
+};
+
+/**
+ * Layout of the project produced by the generator: classification of every module inside of the header dump,
+ * and the module and plugin lists of the sanitized descriptors. Written as JSON by the dry run
+ */
+class FProjectGenerationPlan {
+public:
+	void AddModule(const FString& ModuleName, EModuleClassification Classification, const FString& OwnerPluginName, const FString& TargetDirectory, int32 NumFiles);
+	void AddPluginDescriptor(const FString& PluginName, const FString& PluginFilePath, const FPluginDescriptor& PluginDescriptor);
+	void SetProjectDescriptor(const FString& ProjectFilePath, const FProjectDescriptor& ProjectDescriptor);
+	void SetTargetModules(const FString& TargetFilePath, const TSet<FString>& TargetModuleNames);
+
+	int32 GetNumModules(EModuleClassification Classification) const;
+
+	FString ToJsonString() const;
+	bool Save(const FString& PlanFilePath) const;
+
+	static const TCHAR* LexToString(EModuleClassification Classification);
+private:
+	struct FModuleEntry {
+		FString ModuleName;
+		EModuleClassification Classification;
+		FString OwnerPluginName;
+		FString TargetDirectory;
+		int32 NumFiles;
+	};
+	struct FDescriptorEntry {
+		FString Name;
+		FString FilePath;
+		TArray<FString> ModuleNames;
+		TArray<FString> PluginNames;
+	};
+
+	TArray<FModuleEntry> Modules;
+	TArray<FDescriptorEntry> Plugins;
+	FDescriptorEntry Project;
+	FDescriptorEntry Target;
+};
@@ -0,0 +1,1644 @@
+#include "ProjectGenerator.h"
+#include "PluginManifest.h"
+#include "ProjectDescriptor.h"
+#include "EngineDiscoveryCache.h"
+#include "GeneratedFileLinker.h"
+#include "GeneratedFileManifest.h"
+#include "HeaderDumpArchive.h"
+#include "HeaderFileRewriter.h"
+#include "HeaderSplitter.h"
+#include "ModuleBuildSettings.h"
+#include "ModuleDependencyGraph.h"
+#include "ModuleSelection.h"
+#include "ParallelDirectoryWalker.h"
+#include "ProjectGenerationPlan.h"
+#include "ProjectGeneratorSession.h"
+#include "ProjectGeneratorStats.h"
+#include "SyntaxValidator.h"
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "CoreGlobals.h"
+#include "DirectoryWatcherModule.h"
+#include "IDirectoryWatcher.h"
+#include "Misc/FileHelper.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Misc/ScopeExit.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+
+DEFINE_LOG_CATEGORY(LogProjectGenerator);
+
+/** Single file of the module that needs to be copied into the resulting project */
+struct FModuleFileJob {
+	/** Interned, since there are many more files than there are modules */
+	FName ModuleName;
+	FString SourceFilename;
+	FString TargetFilename;
+	/** Header outside of the Private directory, its includes make the public dependencies of the module */
+	bool bIsPublicHeader;
+	/** Forward declarations replacing the include markers of the header, keyed by the object they declare */
+	TMap<FCrossModuleIncludeKey, FString> ForwardDeclarations;
+	/** Includes moved into the source file from its paired header, which uses the forward declarations instead */
+	TArray<FCrossModuleIncludeKey> MovedIncludes;
+	/** Source file has to be rewritten even when it has not changed itself, because the includes moved from its header have */
+	bool bForceProcessing = false;
+	/** Contents of the header produced by splitting the dumped one, used instead of reading the source file */
+	TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> SplitContents;
+};
+
+//Only headers and source files can contain the cross module include markers, everything else is copied as is
+static bool IsRewrittenSourceFile(const FString& Filename) {
+	const FString FileExtension = FPaths::GetExtension(Filename);
+	return FileExtension == TEXT("h") || FileExtension == TEXT("cpp");
+}
+
+//Blocks until all of the futures are ready. Tasks dispatched to the game thread (like object lookups) are still processed when waiting on it
+static void WaitForFutures(const TArray<TFuture<void>>& Futures) {
+	auto AreAllFuturesReady = [&]() {
+		for (const TFuture<void>& Future : Futures) {
+			if (!Future.IsReady()) {
+				return false;
+			}
+		}
+		return true;
+	};
+	
+	if (!IsInGameThread()) {
+		for (const TFuture<void>& Future : Futures) {
+			Future.Wait();
+		}
+		return;
+	}
+	while (!AreAllFuturesReady()) {
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FPlatformProcess::Sleep(0.001f);
+	}
+}
+
+//Runs the job function for each job index, either inline or spread across the given number of workers
+//Workers run on the task graph, unless the dedicated I/O thread pool is given, which can have more threads than there are cores
+static void ExecuteParallelJobs(int32 NumJobs, int32 NumThreads, FQueuedThreadPool* IOThreadPool, TFunctionRef<void(int32)> JobFunction) {
+	const int32 NumWorkers = FMath::Min(NumThreads, NumJobs);
+
+	if (NumWorkers <= 1) {
+		for (int32 JobIndex = 0; JobIndex < NumJobs; JobIndex++) {
+			JobFunction(JobIndex);
+		}
+		return;
+	}
+
+	//Each worker keeps grabbing the next job until there are none left, which balances modules of very different sizes
+	FThreadSafeCounter NextJobIndex;
+	auto RunWorker = [&NextJobIndex, NumJobs, JobFunction]() {
+		int32 JobIndex;
+		while ((JobIndex = NextJobIndex.Increment() - 1) < NumJobs) {
+			JobFunction(JobIndex);
+		}
+	};
+
+	if (IOThreadPool != NULL) {
+		//Workers spend most of their time blocked on the reads and writes, so the pool keeps that many of them in flight at once
+		TArray<TFuture<void>> Workers;
+		for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; WorkerIndex++) {
+			Workers.Add(AsyncPool(*IOThreadPool, RunWorker));
+		}
+		WaitForFutures(Workers);
+		return;
+	}
+
+	FGraphEventArray WorkerTasks;
+	for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; WorkerIndex++) {
+		WorkerTasks.Add(FFunctionGraphTask::CreateAndDispatchWhenReady(RunWorker, TStatId(), NULL, ENamedThreads::AnyThread));
+	}
+
+	//When waiting on the game thread, tasks dispatched to it by the workers (like object lookups) are still processed
+	const ENamedThreads::Type CurrentThread = IsInGameThread() ? ENamedThreads::GameThread : ENamedThreads::AnyThread;
+	FTaskGraphInterface::Get().WaitUntilTasksComplete(WorkerTasks, CurrentThread);
+}
+
+bool FProjectGenerator::ParseBatchFile(const FString& Params, const FString& BatchFilePath, const FString& Usage, TArray<FCommandletRunParams>& BatchJobs) {
+	UE_LOG(LogProjectGenerator, Display, TEXT("Parsing batch file %s"), *BatchFilePath);
+	
+	TArray<FString> BatchFileLines;
+	if (!FFileHelper::LoadFileToStringArray(BatchFileLines, *BatchFilePath)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Cannot read batch file %s"), *BatchFilePath);
+		return false;
+	}
+
+	//All of the jobs are parsed upfront, so a mistake in the last job does not surface after the rest of the batch has been generated
+	TSet<FString> JobOutputDirectories;
+
+	for (int32 LineIndex = 0; LineIndex < BatchFileLines.Num(); LineIndex++) {
+		const FString JobLine = BatchFileLines[LineIndex].TrimStartAndEnd();
+
+		//Skip empty lines and comments
+		if (JobLine.IsEmpty() || JobLine.StartsWith(TEXT("#"))) {
+			continue;
+		}
+
+		//Arguments given to the commandlet itself apply to every job, unless the job line overrides them
+		FCommandletRunParams& JobParams = BatchJobs.AddDefaulted_GetRef();
+		if (!ParseRunParams(JobLine + TEXT(" ") + Params, Usage, JobParams)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Invalid job at line %d of the batch file %s"), LineIndex + 1, *BatchFilePath);
+			return false;
+		}
+
+		//Jobs writing into the same directory would overwrite each other's files and manifests
+		const FString FullOutputDirectory = FPaths::ConvertRelativePathToFull(JobParams.OutputDirectory);
+		if (JobOutputDirectories.Contains(FullOutputDirectory)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Job at line %d of the batch file %s uses the same output directory as one of the previous jobs"), LineIndex + 1, *BatchFilePath);
+			return false;
+		}
+		JobOutputDirectories.Add(FullOutputDirectory);
+	}
+
+	if (BatchJobs.Num() == 0) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Batch file %s does not contain any jobs"), *BatchFilePath);
+	}
+	return true;
+}
+
+int32 FProjectGenerator::RunBatch(TArray<FCommandletRunParams>& BatchJobs, int32 BatchConcurrency, FProjectGeneratorSession& Session) {
+	BatchConcurrency = FMath::Clamp(BatchConcurrency, 1, FMath::Max(BatchJobs.Num(), 1));
+
+	TArray<int32> JobResults;
+	JobResults.Init(0, BatchJobs.Num());
+
+	auto RunBatchJob = [&](int32 JobIndex) {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Running batch job %d/%d for project %s"), JobIndex + 1, BatchJobs.Num(), *BatchJobs[JobIndex].ProjectName);
+		JobResults[JobIndex] = Generate(BatchJobs[JobIndex], Session);
+	};
+
+	UE_LOG(LogProjectGenerator, Display, TEXT("Running %d batch jobs, %d at a time"), BatchJobs.Num(), BatchConcurrency);
+	
+	if (BatchConcurrency == 1) {
+		for (int32 JobIndex = 0; JobIndex < BatchJobs.Num(); JobIndex++) {
+			RunBatchJob(JobIndex);
+		}
+	} else {
+		//Jobs run on dedicated threads rather than on the task graph workers, because every job blocks waiting for its own file processing tasks
+		Session.bRunningConcurrentJobs = true;
+		FThreadSafeCounter NextJobIndex;
+		TArray<TFuture<void>> JobRunners;
+
+		for (int32 RunnerIndex = 0; RunnerIndex < BatchConcurrency; RunnerIndex++) {
+			JobRunners.Add(Async(EAsyncExecution::Thread, [&]() {
+				int32 JobIndex;
+				while ((JobIndex = NextJobIndex.Increment() - 1) < BatchJobs.Num()) {
+					RunBatchJob(JobIndex);
+				}
+			}));
+		}
+
+		//Object lookups made by all of the jobs are dispatched to the game thread, so it keeps processing them until every job is done
+		WaitForFutures(JobRunners);
+		Session.bRunningConcurrentJobs = false;
+	}
+
+	int32 FailedJobs = 0;
+	for (int32 JobIndex = 0; JobIndex < BatchJobs.Num(); JobIndex++) {
+		if (JobResults[JobIndex] != 0) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Batch job %d for project %s has failed"), JobIndex + 1, *BatchJobs[JobIndex].ProjectName);
+			FailedJobs++;
+		}
+	}
+	UE_LOG(LogProjectGenerator, Display, TEXT("Finished %d batch jobs, %d of them failed"), BatchJobs.Num(), FailedJobs);
+	Session.IncludeResolver->LogCacheStatistics();
+	
+	return FailedJobs ? 1 : 0;
+}
+
+int32 FProjectGenerator::Watch(FCommandletRunParams& Params, const FString& Usage, FProjectGeneratorSession& Session) {
+	//Archive is read once when it is mounted, and the directory watcher cannot look inside of it anyway
+	if (FHeaderDumpArchivePlatformFile::IsMountedArchive(Params.GeneratedHeaderDir)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Watch mode needs the extracted header dump, %s is an archive"), *Params.GeneratedHeaderDir);
+		return 1;
+	}
+
+	//Modules and their selection are kept from the last full generation, so the regenerations only process the modules owning the changed files
+	FProjectGeneratorWatchState WatchState;
+	Params.WatchState = &WatchState;
+	if (Generate(Params, Session) != 0) {
+		return 1;
+	}
+
+	FString ProjectFilePath;
+	FString PluginManifestPath;
+	FParse::Value(*Params.Params, TEXT("ProjectFile="), ProjectFilePath);
+	FParse::Value(*Params.Params, TEXT("PluginManifest="), PluginManifestPath);
+	
+	const FString FullHeaderRoot = FPaths::ConvertRelativePathToFull(Params.GeneratedHeaderDir) / TEXT("");
+	const FString FullProjectFilePath = FPaths::ConvertRelativePathToFull(ProjectFilePath);
+	const FString FullPluginManifestPath = FPaths::ConvertRelativePathToFull(PluginManifestPath);
+
+	//Changes are accumulated until the files stop changing for a moment, so the dump being written triggers a single regeneration
+	const double ChangeSettleSeconds = 0.25;
+	TSet<FString> ChangedSourceFiles;
+	bool bDescriptorsChanged = false;
+	double LastChangeTime = 0.0;
+
+	//Directory watcher is a developer module, so it is only loaded here and is missing from the standalone program built without the developer tools
+	FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::LoadModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+	if (DirectoryWatcherModule == NULL) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Watch mode needs the DirectoryWatcher module, which is not available in this build"));
+		return 1;
+	}
+	IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule->Get();
+	if (DirectoryWatcher == NULL) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Directory watcher is not available on this platform"));
+		return 1;
+	}
+	
+	const IDirectoryWatcher::FDirectoryChanged OnDirectoryChanged = IDirectoryWatcher::FDirectoryChanged::CreateLambda([&](const TArray<FFileChangeData>& FileChanges) {
+		for (const FFileChangeData& FileChange : FileChanges) {
+			const FString FullFilename = FPaths::ConvertRelativePathToFull(FileChange.Filename);
+			
+			if (FullFilename == FullProjectFilePath || FullFilename == FullPluginManifestPath) {
+				bDescriptorsChanged = true;
+			} else if (FullFilename.StartsWith(FullHeaderRoot)) {
+				ChangedSourceFiles.Add(FullFilename);
+			} else {
+				continue;
+			}
+			LastChangeTime = FPlatformTime::Seconds();
+		}
+	});
+
+	//Descriptors are watched through their directories, ignoring the rest of the files and the subdirectories there
+	TArray<TPair<FString, FDelegateHandle>> WatchedDirectories;
+	auto WatchDirectory = [&](const FString& Directory, uint32 WatchFlags) {
+		FDelegateHandle WatchHandle;
+		if (!DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(Directory, OnDirectoryChanged, WatchHandle, WatchFlags)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Failed to watch directory %s for changes"), *Directory);
+			return false;
+		}
+		WatchedDirectories.Add(TPair<FString, FDelegateHandle>(Directory, WatchHandle));
+		return true;
+	};
+	ON_SCOPE_EXIT {
+		for (const TPair<FString, FDelegateHandle>& WatchedDirectory : WatchedDirectories) {
+			DirectoryWatcher->UnregisterDirectoryChangedCallback_Handle(WatchedDirectory.Key, WatchedDirectory.Value);
+		}
+	};
+
+	TSet<FString> DescriptorDirectories;
+	DescriptorDirectories.Add(FPaths::GetPath(FullProjectFilePath));
+	DescriptorDirectories.Add(FPaths::GetPath(FullPluginManifestPath));
+	
+	if (!WatchDirectory(FPaths::ConvertRelativePathToFull(Params.GeneratedHeaderDir), 0)) {
+		return 1;
+	}
+	for (const FString& DescriptorDirectory : DescriptorDirectories) {
+		if (!WatchDirectory(DescriptorDirectory, IDirectoryWatcher::WatchOptions::IgnoreChangesInSubtree)) {
+			return 1;
+		}
+	}
+	UE_LOG(LogProjectGenerator, Display, TEXT("Watching %s, %s and %s for changes, press Ctrl+C to stop"), *Params.GeneratedHeaderDir, *ProjectFilePath, *PluginManifestPath);
+
+	double LastTickTime = FPlatformTime::Seconds();
+	while (!IsEngineExitRequested()) {
+		const double CurrentTime = FPlatformTime::Seconds();
+		DirectoryWatcher->Tick(CurrentTime - LastTickTime);
+		LastTickTime = CurrentTime;
+
+		if ((ChangedSourceFiles.Num() || bDescriptorsChanged) && CurrentTime - LastChangeTime >= ChangeSettleSeconds) {
+			//Changed descriptors can change the module classification, so every file is checked against the manifest
+			//Otherwise only the changed files of the changed modules are processed, and the descriptors are still written when their contents have changed
+			bool bCanRegenerate = true;
+			if (bDescriptorsChanged) {
+				FCommandletRunParams ReloadedParams;
+				if (ParseRunParams(Params.Params, Usage, ReloadedParams)) {
+					Params = MoveTemp(ReloadedParams);
+				} else {
+					UE_LOG(LogProjectGenerator, Error, TEXT("Cannot reload the project file or plugin manifest, waiting for the next change"));
+					bCanRegenerate = false;
+				}
+			}
+
+			if (bCanRegenerate) {
+				UE_LOG(LogProjectGenerator, Display, TEXT("Regenerating the project after %d file changes%s"), ChangedSourceFiles.Num(), bDescriptorsChanged ? TEXT(" and descriptor changes") : TEXT(""));
+				
+				//Adding or removing the module directory changes the classification and the selection, so it needs the full generation too
+				TSet<FString> ChangedModules;
+				bool bModuleDirectoriesChanged = false;
+				for (const FString& ChangedSourceFile : ChangedSourceFiles) {
+					const FString RelativeFilename = ChangedSourceFile.Mid(FullHeaderRoot.Len());
+					FString ModuleName = RelativeFilename;
+					RelativeFilename.Split(TEXT("/"), &ModuleName, NULL);
+					const bool bModuleDirectoryExists = FPlatformFileManager::Get().GetPlatformFile().DirectoryExists(*(FullHeaderRoot / ModuleName));
+					bModuleDirectoriesChanged |= WatchState.HeaderDumpModules.Contains(ModuleName) != bModuleDirectoryExists;
+					ChangedModules.Add(ModuleName);
+				}
+				
+				FCommandletRunParams WatchParams = Params;
+				WatchParams.bIncremental = true;
+				WatchParams.bOnlyChangedFiles = !bDescriptorsChanged && !bModuleDirectoriesChanged;
+				WatchParams.ChangedSourceFiles = MoveTemp(ChangedSourceFiles);
+				WatchParams.ChangedModules = MoveTemp(ChangedModules);
+				WatchParams.WatchState = &WatchState;
+				Generate(WatchParams, Session);
+			}
+			ChangedSourceFiles.Reset();
+			bDescriptorsChanged = false;
+		}
+		FPlatformProcess::Sleep(0.05f);
+	}
+	return 0;
+}
+
+bool FProjectGenerator::ParseRunParams(const FString& Params, const FString& Usage, FCommandletRunParams& ResultParams) {
+	ResultParams.Params = Params;
+
+	{
+		FString PluginManifestFile;
+		if (!FParse::Value(*Params, TEXT("PluginManifest="), PluginManifestFile)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Missing plugin manifest. Usage: %s"), *Usage);
+			return false;
+		}
+	
+		FText ManifestLoadErrorText;
+		if (!ResultParams.PluginManifest.Load(PluginManifestFile, ManifestLoadErrorText)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Cannot parse plugin manifest: %s"), *ManifestLoadErrorText.ToString());
+			return false;
+		}
+	}
+	
+	{
+		FString ProjectFilePath;
+		if (!FParse::Value(*Params, TEXT("ProjectFile="), ProjectFilePath)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Missing project file. Usage: %s"), *Usage);
+			return false;
+		}
+		ResultParams.ProjectName = FPaths::GetBaseFilename(ProjectFilePath);
+		
+		FText ProjectFileErrorText;
+		if (!ResultParams.ProjectFile.Load(ProjectFilePath, ProjectFileErrorText)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Cannot parse project file: %s"), *ProjectFileErrorText.ToString());
+			return false;
+		}
+	}
+
+	{
+		if (!FParse::Value(*Params, TEXT("HeaderRoot="), ResultParams.GeneratedHeaderDir)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Missing header root directory. Usage: %s"), *Usage);
+			return false;
+		}
+
+		//Archive is mounted in place of the directory at the same path, so the rest of the generation reads it like the extracted dump
+		if (FHeaderDumpArchive::IsArchiveFilename(ResultParams.GeneratedHeaderDir)) {
+			FString ArchiveErrorMessage;
+			if (!FHeaderDumpArchivePlatformFile::MountArchive(ResultParams.GeneratedHeaderDir, ArchiveErrorMessage)) {
+				UE_LOG(LogProjectGenerator, Error, TEXT("Cannot read header dump archive %s: %s"), *ResultParams.GeneratedHeaderDir, *ArchiveErrorMessage);
+				return false;
+			}
+		}
+
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		if (!PlatformFile.DirectoryExists(*ResultParams.GeneratedHeaderDir)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Provided header directory does not exist"));
+			return false;
+		}
+	}
+	
+	{
+		if (!FParse::Value(*Params, TEXT("OutputDir="), ResultParams.OutputDirectory)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Missing output project dir. Usage: %s"), *Usage);
+			return false;
+		}
+
+		//Dry run never writes into the output directory, so it does not need to exist yet
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		if (!FParse::Param(*Params, TEXT("DryRun")) && !PlatformFile.DirectoryExists(*ResultParams.OutputDirectory)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Provided output directory does not exist"));
+			return false;
+		}
+	}
+	
+	//Number of threads used to process module files, 0 picks one per available task graph worker
+	if (FParse::Value(*Params, TEXT("Threads="), ResultParams.NumThreads)) {
+		if (ResultParams.NumThreads <= 0) {
+			ResultParams.NumThreads = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+		}
+	}
+	
+	//Number of dedicated threads doing the file reads and writes, 0 keeps them on the task graph workers
+	if (FParse::Value(*Params, TEXT("IOWorkers="), ResultParams.NumIOThreads)) {
+		ResultParams.NumIOThreads = FMath::Max(ResultParams.NumIOThreads, 0);
+	}
+
+	//Memory available to the generation, large files are streamed instead of being loaded as a whole to stay within it. 0 means no limit
+	if (FParse::Value(*Params, TEXT("MemoryLimitMB="), ResultParams.MemoryLimitMB)) {
+		ResultParams.MemoryLimitMB = FMath::Max(ResultParams.MemoryLimitMB, 0);
+	}
+	
+	ResultParams.bIncremental = FParse::Param(*Params, TEXT("Incremental"));
+	FParse::Value(*Params, TEXT("StatsFile="), ResultParams.StatsFilePath);
+	ResultParams.bDryRun = FParse::Param(*Params, TEXT("DryRun"));
+	ResultParams.bGeneratePCH = FParse::Param(*Params, TEXT("GeneratePCH"));
+	ResultParams.bPruneBuildDependencies = FParse::Param(*Params, TEXT("PruneBuildDependencies"));
+	ResultParams.bForwardDeclare = FParse::Param(*Params, TEXT("ForwardDeclare"));
+	ResultParams.bSplitHeaders = FParse::Param(*Params, TEXT("SplitHeaders"));
+	ResultParams.bValidateSyntax = FParse::Param(*Params, TEXT("ValidateSyntax"));
+	FParse::Value(*Params, TEXT("SyntaxCompiler="), ResultParams.SyntaxCompiler);
+	FParse::Value(*Params, TEXT("SyntaxCompilerArgs="), ResultParams.SyntaxCompilerArguments, false);
+
+	//Comma separated list of the modules to generate along with everything they include, the whole dump is generated without it
+	FString SelectedModuleList;
+	if (FParse::Value(*Params, TEXT("Modules="), SelectedModuleList, false)) {
+		SelectedModuleList.ParseIntoArray(ResultParams.SelectedModules, TEXT(","));
+	}
+	FParse::Value(*Params, TEXT("DependencyGraph="), ResultParams.DependencyGraphPath);
+	FParse::Value(*Params, TEXT("PlanFile="), ResultParams.PlanFilePath);
+
+	FString LinkModeName;
+	if (FParse::Value(*Params, TEXT("LinkMode="), LinkModeName) && !FGeneratedFileLinker::ParseLinkMode(LinkModeName, ResultParams.LinkMode)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Unknown link mode %s, expected hardlink, reflink or copy. Usage: %s"), *LinkModeName, *Usage);
+		return false;
+	}
+	return true;
+}
+
+
+
+int32 FProjectGenerator::Generate(FCommandletRunParams& Params, FProjectGeneratorSession& Session) {
+	UE_LOG(LogProjectGenerator, Display, TEXT("Collecting plugin module list"));
+	FProjectGeneratorStats Stats;
+
+	//Collect registered plugins inside of the packaged game
+	TMap<FName, FString> ModuleNameToOwnerPluginName;
+	TMap<FString, FString> GameImpliedPluginFileLocations;
+	TSet<FString> GameEnginePlugins;
+
+	const FString ProjectSourceDir = Params.OutputDirectory / TEXT("Source");
+	const FString GameProjectPluginDir = FString::Printf(TEXT("../../../%s/Plugins/"), *Params.ProjectName);
+	const FString GameEnginePluginDir = TEXT("../../../Engine/Plugins/");
+
+	for (const FPluginManifestEntry& ManifestEntry : Params.PluginManifest.Contents) {
+		const FString PluginName = FPaths::GetBaseFilename(ManifestEntry.File);
+	
+		for (const FModuleDescriptor& ModuleInfo : ManifestEntry.Descriptor.Modules) {
+			ModuleNameToOwnerPluginName.Add(ModuleInfo.Name, PluginName);
+		}
+
+		const FString PluginFilename = ManifestEntry.File;
+
+		if (PluginFilename.StartsWith(GameProjectPluginDir)) {
+			const FString RelativeFileLocation = PluginFilename.Mid(GameProjectPluginDir.Len());
+			const FString FullFilePath = Params.OutputDirectory / TEXT("Plugins") / RelativeFileLocation;
+			
+			GameImpliedPluginFileLocations.Add(PluginName, FullFilePath);
+
+		} else if (PluginFilename.StartsWith(GameEnginePluginDir)) {
+			const FString RelativeFileLocation = PluginFilename.Mid(GameEnginePluginDir.Len());
+			const FString FullFilePath = Params.OutputDirectory / TEXT("Plugins/EnginePlugins") / RelativeFileLocation;
+			
+			GameImpliedPluginFileLocations.Add(PluginName, FullFilePath);
+			GameEnginePlugins.Add(PluginName);
+		} else {
+			UE_LOG(LogProjectGenerator, Warning, TEXT("Found game plugin not located inside of the engine or project directories: %s"), *PluginFilename);
+		}
+	}
+
+	//All game modules referenced through the project descriptor file
+	TSet<FString> ProjectModuleNames;
+
+	for (const FModuleDescriptor& ModuleDescriptor : Params.ProjectFile.Modules) {
+		const FString ModuleName = ModuleDescriptor.Name.ToString();
+
+		//Need to check whenever the module belongs to any of plugins first, DBD lists some of the plugin-contained modules explicitly inside of the project modules
+		if (!ModuleNameToOwnerPluginName.Contains(ModuleDescriptor.Name)) {
+			ProjectModuleNames.Add(ModuleName);
+		}
+	}
+	
+	//Engine modules and plugins have been discovered when the session started, so we can compare against what we already have
+	const TMap<FString, TSet<FString>>& EnginePlugins = Session.EngineSnapshot.EnginePlugins;
+	const TSet<FString>& EngineModules = Session.EngineSnapshot.EngineModules;
+	Stats.AddPhaseTime(TEXT("EngineDiscovery"), Session.EngineDiscoverySeconds);
+
+	//Resolver is shared by all of the jobs in the session, so only the work done since this job has started is attributed to it
+	//Objects moved into the split headers are resolved to them, everything else goes to the resolver of the session
+	FSplitHeaderIncludeResolver IncludeResolver(*Session.IncludeResolver);
+	const FHeaderFileRewriter HeaderFileRewriter(IncludeResolver);
+	
+	const int32 InitialCacheHits = IncludeResolver.GetCacheHits();
+	const int32 InitialCacheMisses = IncludeResolver.GetCacheMisses();
+	const int32 InitialModulesForceLoaded = IncludeResolver.GetModulesForceLoaded();
+	const double InitialModuleLoadingSeconds = IncludeResolver.GetModuleLoadingSeconds();
+	
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	//Descriptors and build rules that could not be written fail the job once everything else has been generated
+	bool bGeneratedFilesSaved = true;
+
+	//Manifest of the previous run is used to skip the files that did not change, and the new one is always written for the next run
+	const FString ManifestFilePath = Params.OutputDirectory / FGeneratedFileManifest::ManifestFileName;
+	const FString OutputDirectoryWithSlash = Params.OutputDirectory / TEXT("");
+	FGeneratedFileManifest PreviousManifest;
+	FGeneratedFileManifest NewManifest;
+	
+	if (Params.bIncremental && PreviousManifest.Load(ManifestFilePath)) {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Loaded generated file manifest with %d files, unchanged files will be skipped"), PreviousManifest.Num());
+	}
+
+	//Watch mode only hands over the files changed since its previous run, the rest of them are taken from the manifest that run has written
+	auto FindCarriedOverFileRecord = [&](const FModuleFileJob& FileJob, FGeneratedFileRecord& OutFileRecord) {
+		if (!Params.bOnlyChangedFiles || FileJob.bForceProcessing || Params.ChangedSourceFiles.Contains(FPaths::ConvertRelativePathToFull(FileJob.SourceFilename))) {
+			return false;
+		}
+		FString RelativeTargetFilename = FileJob.TargetFilename;
+		FPaths::MakePathRelativeTo(RelativeTargetFilename, *OutputDirectoryWithSlash);
+		return PreviousManifest.FindFile(RelativeTargetFilename, OutFileRecord);
+	};
+
+	//With the state of the last full run, the watch mode also keeps its module selection and only walks the directories of the modules owning the changed files
+	const bool bUsesWatchState = Params.bOnlyChangedFiles && Params.WatchState != NULL && Params.WatchState->bIsValid;
+	TMap<FString, TArray<FString>> CarriedOverModuleFiles;
+
+	//Includes resolved for the files of every module, turned into the dependency graph, the precompiled headers and the build rules of the modules
+	const bool bCollectDependencyGraph = Params.bGeneratePCH || Params.bPruneBuildDependencies || !Params.DependencyGraphPath.IsEmpty();
+	FModuleDependencyGraph DependencyGraph;
+	FModuleBuildSettings ModuleBuildSettings;
+	TMap<FString, FString> ModuleSourceDirectories;
+	TMap<FString, FString> ModuleTargetDirectories;
+
+	//Files of all modules we are going to generate, collected first so they can be processed in parallel afterwards
+	TArray<FModuleFileJob> ModuleFileJobs;
+
+	auto CollectModuleFilesRecursive = [&](const FString& ModuleName, const FString& SourceDirectory, const FString& ResultDirectory, const TCHAR* Filename, bool bIsDirectory) {
+		//Only interested in the loose files, directories for them are created before the files are written
+		if (bIsDirectory) {
+			return true;
+		}
+
+		//Compute the new absolute path for the file in question
+		const FString SourceDirectoryWithSlash = SourceDirectory / TEXT("");
+		FString RelativePathToFile = Filename;
+		FPaths::MakePathRelativeTo(RelativePathToFile, *SourceDirectoryWithSlash);
+
+		//Build rules of the dump are replaced with the generated or pruned ones, which are written after all of the module files have been processed
+		if ((Params.bGeneratePCH || Params.bPruneBuildDependencies) && RelativePathToFile == ModuleName + TEXT(".Build.cs")) {
+			return true;
+		}
+
+		FModuleFileJob& FileJob = ModuleFileJobs.AddDefaulted_GetRef();
+		FileJob.ModuleName = FName(*ModuleName);
+		FileJob.SourceFilename = Filename;
+		FileJob.TargetFilename = ResultDirectory / RelativePathToFile;
+		FileJob.bIsPublicHeader = FPaths::GetExtension(RelativePathToFile) == TEXT("h") && !RelativePathToFile.StartsWith(TEXT("Private/"));
+		return true;
+	};
+
+	//Files without any include markers are identical to their sources, so they can be linked instead of copied
+	//Files of the archive do not exist on the disk though, so they can only be copied
+	const bool bIsHeaderDumpArchive = FHeaderDumpArchivePlatformFile::IsMountedArchive(Params.GeneratedHeaderDir);
+	if (bIsHeaderDumpArchive && Params.LinkMode != EGeneratedFileLinkMode::Copy) {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Header dump is read from the archive, files will be copied instead of creating %s"), FGeneratedFileLinker::LexToString(Params.LinkMode));
+	}
+	FGeneratedFileLinker FileLinker(bIsHeaderDumpArchive ? EGeneratedFileLinkMode::Copy : Params.LinkMode);
+	const bool bLinksModuleFiles = !bIsHeaderDumpArchive && Params.LinkMode != EGeneratedFileLinkMode::Copy;
+
+	//Chunk size is only known once the number of the file threads is, zero means that the files are always loaded as a whole
+	int64 StreamingChunkSize = 0;
+	auto IsStreamedFile = [&](const FString& Filename) {
+		return StreamingChunkSize > 0 && PlatformFile.FileSize(*Filename) > StreamingChunkSize;
+	};
+	auto LoadModuleFileContents = [&](const FModuleFileJob& FileJob, TArray<uint8>& OutFileContents) {
+		if (FileJob.SplitContents.IsValid()) {
+			OutFileContents = *FileJob.SplitContents;
+			return true;
+		}
+		return FHeaderFileRewriter::LoadFileContents(FileJob.SourceFilename, OutFileContents);
+	};
+
+	auto ProcessModuleFile = [&](const FModuleFileJob& FileJob) {
+		FScopedGeneratorTraceEvent FileTraceEvent(*FileJob.ModuleName.ToString());
+		const double FileStartTime = FPlatformTime::Seconds();
+		ON_SCOPE_EXIT {
+			Stats.AddModuleFileTime(FileJob.ModuleName, FileStartTime, FPlatformTime::Seconds());
+		};
+		
+		const bool bIsSourceFile = IsRewrittenSourceFile(FileJob.TargetFilename);
+
+		FString RelativeTargetFilename = FileJob.TargetFilename;
+		FPaths::MakePathRelativeTo(RelativeTargetFilename, *OutputDirectoryWithSlash);
+
+		FGeneratedFileRecord CarriedOverFileRecord;
+		if (FindCarriedOverFileRecord(FileJob, CarriedOverFileRecord)) {
+			NewManifest.AddFile(RelativeTargetFilename, CarriedOverFileRecord);
+			Stats.FilesSkipped.Increment();
+			return;
+		}
+
+		//Files are read as raw bytes in one go, and only the lines with the include markers are ever converted into strings
+		//With the memory limit, files larger than the chunk size are streamed instead, and are never held in memory as a whole
+		//Other files are only ever carried over as they are, so they are hashed without being loaded, unless they are going to be copied from the same buffer
+		TArray<uint8> SourceFileContents;
+		FHeaderFileScan SourceFileScan;
+		const bool bIsRewrittenFile = bIsSourceFile || FileJob.SplitContents.IsValid();
+		const bool bIsStreamedFile = bIsRewrittenFile && !FileJob.SplitContents.IsValid() && IsStreamedFile(FileJob.SourceFilename) && FHeaderFileRewriter::ScanFileInChunks(FileJob.SourceFilename, StreamingChunkSize, SourceFileScan);
+		const bool bIsHashedFile = !bIsRewrittenFile && (bLinksModuleFiles || IsStreamedFile(FileJob.SourceFilename));
+		
+		//Contents still hold the raw bytes of the source file unless they have been converted from UTF-16, and can be written out instead of copying the file again
+		bool bHoldsRawSourceContents = false;
+		if (bIsHashedFile) {
+			SourceFileScan.FileSize = PlatformFile.FileSize(*FileJob.SourceFilename);
+			SourceFileScan.SourceHash = FGeneratedFileManifest::HashFile(FileJob.SourceFilename);
+		} else if (!bIsStreamedFile) {
+			if (FileJob.SplitContents.IsValid()) {
+				SourceFileContents = *FileJob.SplitContents;
+			} else if (!FFileHelper::LoadFileToArray(SourceFileContents, *FileJob.SourceFilename)) {
+				UE_LOG(LogProjectGenerator, Error, TEXT("Failed to read module file %s"), *FileJob.SourceFilename);
+				return;
+			}
+			//Source hash always covers the raw bytes, so it matches the output hash of the files that are carried over without being rewritten
+			SourceFileScan.FileSize = SourceFileContents.Num();
+			SourceFileScan.SourceHash = FGeneratedFileManifest::HashBytes(SourceFileContents.GetData(), SourceFileContents.Num());
+			bHoldsRawSourceContents = !FileJob.SplitContents.IsValid() && !(bIsSourceFile && FHeaderFileRewriter::ConvertUTF16ContentsToUTF8(SourceFileContents));
+		}
+
+		Stats.FilesProcessed.Increment();
+		Stats.BytesRead.Add(SourceFileScan.FileSize);
+
+		FGeneratedFileRecord FileRecord;
+		FileRecord.SourceHash = SourceFileScan.SourceHash;
+
+		//If the file is a header or CPP file, we need to process it explicitly
+		TArray<FHeaderLineReplacement> LineReplacements;
+		if (bIsSourceFile) {
+			if (bIsStreamedFile) {
+				HeaderFileRewriter.ResolveIncludeMarkers(FileJob.SourceFilename, SourceFileScan.IncludeMarkers, LineReplacements, &FileJob.ForwardDeclarations);
+			} else {
+				HeaderFileRewriter.ResolveIncludeMarkers(FileJob.SourceFilename, SourceFileContents, LineReplacements, &FileJob.ForwardDeclarations);
+			}
+
+			//Includes moved from the paired header go right after the first include of the source file, which is normally that header
+			if (FileJob.MovedIncludes.Num()) {
+				bool bInsertionAfterUnterminatedLine = SourceFileScan.bIncludeInsertionAfterUnterminatedLine;
+				const int64 InsertionOffset = bIsStreamedFile ? SourceFileScan.IncludeInsertionOffset : FHeaderFileRewriter::FindIncludeInsertionOffset(SourceFileContents, bInsertionAfterUnterminatedLine);
+				
+				for (const FCrossModuleIncludeKey& MovedInclude : FileJob.MovedIncludes) {
+					FString ResolvedIncludeString;
+					if (IncludeResolver.ResolveInclude(FileJob.SourceFilename, MovedInclude, ResolvedIncludeString)) {
+						//Only the first inserted line needs to terminate the last line of the file, the following ones come after its own terminator
+						LineReplacements.Add(FHeaderLineReplacement{InsertionOffset, 0, MoveTemp(ResolvedIncludeString), MovedInclude.ModuleName, bInsertionAfterUnterminatedLine});
+						bInsertionAfterUnterminatedLine = false;
+					}
+				}
+				//Inserted lines come before the line replaced at the same offset
+				LineReplacements.StableSort([](const FHeaderLineReplacement& A, const FHeaderLineReplacement& B) {
+					return A.LineOffset < B.LineOffset || (A.LineOffset == B.LineOffset && A.LineLength < B.LineLength);
+				});
+			}
+
+			TArray<FString> ResolvedIncludes;
+			for (const FHeaderLineReplacement& LineReplacement : LineReplacements) {
+				ResolvedIncludes.Add(LineReplacement.NewLine);
+			}
+			FileRecord.IncludeSetHash = FGeneratedFileManifest::HashStrings(ResolvedIncludes);
+			Stats.IncludeMarkersResolved.Add(LineReplacements.Num());
+
+			if (bCollectDependencyGraph) {
+				DependencyGraph.AddFileIncludes(FileJob.ModuleName.ToString(), FileJob.bIsPublicHeader, LineReplacements);
+			}
+			if (Params.bGeneratePCH) {
+				ModuleBuildSettings.AddFileIncludes(FileJob.ModuleName.ToString(), LineReplacements);
+			}
+		}
+
+		//Leave the file alone if it has been generated from the same source and includes during the previous run
+		if (Params.bIncremental && PreviousManifest.IsFileUpToDate(RelativeTargetFilename, FileJob.TargetFilename, FileRecord.SourceHash, FileRecord.IncludeSetHash, FileRecord.OutputHash)) {
+			NewManifest.AddFile(RelativeTargetFilename, FileRecord);
+			Stats.FilesSkipped.Increment();
+			return;
+		}
+
+		//Files that already have the same contents in the output directory are left untouched along with their timestamps, so they do not invalidate the builds
+		//Split headers do not exist in the header dump, so they are always written even when there is nothing to replace
+		if (LineReplacements.Num() || FileJob.SplitContents.IsValid()) {
+			int64 BytesWritten = 0;
+			bool bUnchanged = false;
+			const bool bWriteSucceeded = bIsStreamedFile ?
+				FHeaderFileRewriter::WriteRewrittenFileInChunks(FileJob.TargetFilename, FileJob.SourceFilename, SourceFileScan, StreamingChunkSize, LineReplacements, FileRecord.OutputHash, BytesWritten, bUnchanged) :
+				FHeaderFileRewriter::WriteRewrittenFile(FileJob.TargetFilename, SourceFileContents, LineReplacements, FileRecord.OutputHash, BytesWritten, bUnchanged);
+			if (!bWriteSucceeded) {
+				return;
+			}
+			if (bUnchanged) {
+				Stats.FilesUnchanged.Increment();
+			}
+			Stats.BytesWritten.Add(BytesWritten);
+		} else if (PlatformFile.FileSize(*FileJob.TargetFilename) == SourceFileScan.FileSize && FGeneratedFileManifest::HashFile(FileJob.TargetFilename) == FileRecord.SourceHash) {
+			FileRecord.OutputHash = FileRecord.SourceHash;
+			Stats.FilesUnchanged.Increment();
+		} else if (bHoldsRawSourceContents && !bLinksModuleFiles) {
+			//Contents have already been read for the hash, so they are written out rather than reading the source file again
+			PlatformFile.DeleteFile(*FileJob.TargetFilename);
+			if (!FFileHelper::SaveArrayToFile(SourceFileContents, *FileJob.TargetFilename)) {
+				UE_LOG(LogProjectGenerator, Error, TEXT("Failed to write module file %s"), *FileJob.TargetFilename);
+				return;
+			}
+			FileRecord.OutputHash = FileRecord.SourceHash;
+			Stats.BytesWritten.Add(SourceFileScan.FileSize);
+		} else {
+			//Otherwise, link or copy the file as is. Target can still be linked to the source file by one of the previous runs, so it is replaced rather than written through
+			PlatformFile.DeleteFile(*FileJob.TargetFilename);
+
+			bool bLinked = false;
+			if (!FileLinker.LinkOrCopyFile(FileJob.TargetFilename, FileJob.SourceFilename, bLinked)) {
+				UE_LOG(LogProjectGenerator, Error, TEXT("Failed to write module file %s"), *FileJob.TargetFilename);
+				return;
+			}
+			FileRecord.OutputHash = FileRecord.SourceHash;
+			
+			if (bLinked) {
+				Stats.FilesLinked.Increment();
+			} else {
+				Stats.BytesWritten.Add(SourceFileScan.FileSize);
+			}
+		}
+		NewManifest.AddFile(RelativeTargetFilename, FileRecord);
+	};
+
+	//Only the requested modules and the modules they include are generated when the selection is given
+	TSet<FString> SelectedModules;
+	TSet<FString> UnselectedPlugins;
+	auto IsModuleSelected = [&](const FString& ModuleName) {
+		return Params.SelectedModules.Num() == 0 || SelectedModules.Contains(ModuleName);
+	};
+
+	if (Params.SelectedModules.Num()) {
+		FScopedGeneratorPhase SelectionPhase(Stats, TEXT("ModuleSelection"));
+
+		if (bUsesWatchState) {
+			SelectedModules = Params.WatchState->SelectedModules;
+		} else {
+			SelectedModules = FModuleSelection::ComputeClosure(Params.GeneratedHeaderDir, Params.SelectedModules, [&](const FString& ModuleName) {
+				const FString* OwnerPluginName = ModuleNameToOwnerPluginName.Find(FName(*ModuleName));
+				return EngineModules.Contains(ModuleName) || (OwnerPluginName != NULL && EnginePlugins.Contains(*OwnerPluginName));
+			}, Params.NumThreads);
+		}
+
+		//Plugins without any of the selected modules are left out along with the references to them, content only plugins are always kept
+		for (const FPluginManifestEntry& ManifestEntry : Params.PluginManifest.Contents) {
+			const bool bHasSelectedModules = ManifestEntry.Descriptor.Modules.ContainsByPredicate([&](const FModuleDescriptor& ModuleDescriptor) {
+				return SelectedModules.Contains(ModuleDescriptor.Name.ToString());
+			});
+			if (ManifestEntry.Descriptor.Modules.Num() && !bHasSelectedModules) {
+				UnselectedPlugins.Add(FPaths::GetBaseFilename(ManifestEntry.File));
+			}
+		}
+		UE_LOG(LogProjectGenerator, Display, TEXT("Selected %d modules including the modules referenced by the %d requested ones, leaving out %d plugins"), SelectedModules.Num(), Params.SelectedModules.Num(), UnselectedPlugins.Num());
+	}
+
+	//Generate the modules for each folder inside of the headers root
+	TSet<FString> AllGameModulesProcessed;
+	TSet<FString> LooseGameModuleNames;
+	TSet<FString> EngineModulesForcedToBeGameModules;
+
+	int32 PluginModulesCopied = 0;
+	int32 GameModulesCopied = 0;
+
+	//Classification of the modules and the resulting descriptors, emitted as the plan by the dry run
+	FProjectGenerationPlan GenerationPlan;
+	TSet<FString> HeaderDumpModules;
+
+	auto CollectModuleFiles = [&](const FString& ModuleName, const TCHAR* SourceDirectory, const FString& TargetModuleDirectory) {
+		//Files of the modules without any changes are carried over from the manifest of the previous run as they are
+		if (bUsesWatchState && !Params.ChangedModules.Contains(ModuleName)) {
+			FString RelativeTargetDirectory = TargetModuleDirectory / TEXT("");
+			FPaths::MakePathRelativeTo(RelativeTargetDirectory, *OutputDirectoryWithSlash);
+			NewManifest.AddFilesInDirectory(PreviousManifest, RelativeTargetDirectory, CarriedOverModuleFiles.Add(ModuleName));
+			return;
+		}
+		TFunction<bool(const TCHAR*, bool)> CollectFile = [&](const TCHAR* FilenameInner, bool bIsDirectoryInner) {
+			return CollectModuleFilesRecursive(ModuleName, SourceDirectory, TargetModuleDirectory, FilenameInner, bIsDirectoryInner);
+		};
+		PlatformFile.IterateDirectoryRecursively(SourceDirectory, CollectFile);
+	};
+	
+	TFunction<bool(const TCHAR*, bool)> ModuleDirIterator = [&](const TCHAR* Filename, bool bIsDirectory) {
+		//Only interested in actual module directories and not loose files
+		if (!bIsDirectory) {
+			return true;
+		}
+		
+		const FString ModuleName = FPaths::GetCleanFilename(Filename);
+		HeaderDumpModules.Add(ModuleName);
+
+		//This module is owned by one of the plugins
+		if (const FString* OwnerPluginName = ModuleNameToOwnerPluginName.Find(FName(*ModuleName))) {
+
+			//Check if it's one of the existing engine plugins, then we return early and discard the module
+			if (const TSet<FString>* OwnerPluginModules = EnginePlugins.Find(*OwnerPluginName)) {
+
+				//Print a warning when the module belongs to the plugin, but engine plugin does not have that module
+				if (!OwnerPluginModules->Contains(ModuleName)) {
+					UE_LOG(LogProjectGenerator, Warning, TEXT("Engine plugin %s does not have a module %s present in the game"), OwnerPluginName->operator*(), *ModuleName);
+				}
+				GenerationPlan.AddModule(ModuleName, EModuleClassification::EnginePluginModule, *OwnerPluginName, FString(), 0);
+				return true;
+			}
+
+			//Module does not belong to the any of the existing engine plugins
+			if (const FString* ResultPluginFile = GameImpliedPluginFileLocations.Find(*OwnerPluginName)) {
+
+				if (!IsModuleSelected(ModuleName)) {
+					GenerationPlan.AddModule(ModuleName, EModuleClassification::UnselectedModule, *OwnerPluginName, FString(), 0);
+					return true;
+				}
+				const FString PluginDir = FPaths::GetPath(*ResultPluginFile);
+				const FString TargetModuleDirectory = PluginDir / TEXT("Source") / ModuleName;
+
+				const int32 FirstModuleFileJob = ModuleFileJobs.Num();
+				CollectModuleFiles(ModuleName, Filename, TargetModuleDirectory);
+				AllGameModulesProcessed.Add(ModuleName);
+				ModuleSourceDirectories.Add(ModuleName, Filename);
+				ModuleTargetDirectories.Add(ModuleName, TargetModuleDirectory);
+				PluginModulesCopied++;
+				GenerationPlan.AddModule(ModuleName, EModuleClassification::PluginModule, *OwnerPluginName, TargetModuleDirectory, ModuleFileJobs.Num() - FirstModuleFileJob);
+			} else {
+				//No registered game module associated with this plugin, print a warning
+				UE_LOG(LogProjectGenerator, Warning, TEXT("Discarding game module %s because associated plugin %s does not exist"), *ModuleName, OwnerPluginName->operator*());
+				GenerationPlan.AddModule(ModuleName, EModuleClassification::DiscardedModule, *OwnerPluginName, FString(), 0);
+			}
+			return true;
+		}
+		
+		//If this is the normal engine module, we skip it altogether
+		if (EngineModules.Contains(ModuleName)) {
+			GenerationPlan.AddModule(ModuleName, EModuleClassification::EngineModule, FString(), FString(), 0);
+			return true;
+		}
+
+		if (!IsModuleSelected(ModuleName)) {
+			GenerationPlan.AddModule(ModuleName, EModuleClassification::UnselectedModule, FString(), FString(), 0);
+			return true;
+		}
+
+		//Otherwise assume it is a normal game module. If it was not declared inside of the project file, output a warning
+		const bool bIsForcedGameModule = !ProjectModuleNames.Contains(ModuleName);
+		if (bIsForcedGameModule) {
+			EngineModulesForcedToBeGameModules.Add(ModuleName);
+			UE_LOG(LogProjectGenerator, Warning, TEXT("Module %s does not belong to the engine or any plugins, neither it is listed in the project modules. Assuming it is a game module"), *ModuleName);
+		}
+		const FString TargetModuleDirectory = ProjectSourceDir / ModuleName;
+
+		//Copy the game module to the normal directory
+		const int32 FirstModuleFileJob = ModuleFileJobs.Num();
+		CollectModuleFiles(ModuleName, Filename, TargetModuleDirectory);
+
+		AllGameModulesProcessed.Add(ModuleName);
+		ModuleSourceDirectories.Add(ModuleName, Filename);
+		ModuleTargetDirectories.Add(ModuleName, TargetModuleDirectory);
+		LooseGameModuleNames.Add(ModuleName);
+		GameModulesCopied++;
+		GenerationPlan.AddModule(ModuleName, bIsForcedGameModule ? EModuleClassification::ForcedGameModule : EModuleClassification::GameModule, FString(), TargetModuleDirectory, ModuleFileJobs.Num() - FirstModuleFileJob);
+		
+		return true;
+	};
+
+	//Now run the handler for each module we found in the header dump
+	{
+		FScopedGeneratorPhase ClassificationPhase(Stats, TEXT("ModuleClassification"));
+		PlatformFile.IterateDirectory(*Params.GeneratedHeaderDir, ModuleDirIterator);
+	}
+
+	//Full run records the modules for the next regenerations of the watch mode, the split objects are recorded once the headers are split
+	if (Params.WatchState != NULL && !bUsesWatchState && !Params.bDryRun) {
+		Params.WatchState->HeaderDumpModules = MoveTemp(HeaderDumpModules);
+		Params.WatchState->SelectedModules = SelectedModules;
+		Params.WatchState->ModuleSplitObjectIncludePaths.Reset();
+		Params.WatchState->bIsValid = true;
+	}
+
+	//Dry run stops at the classification and the descriptors, and never touches the module files or the output directory
+	if (!Params.bDryRun) {
+		//Reading and writing the files is bound by the storage latency rather than by the CPU, so it can use a dedicated pool with more threads than there are cores
+		FQueuedThreadPool* IOThreadPool = NULL;
+		if (Params.NumIOThreads > 0) {
+			IOThreadPool = FQueuedThreadPool::Allocate();
+			verify(IOThreadPool->Create(Params.NumIOThreads, 128 * 1024));
+		}
+		ON_SCOPE_EXIT {
+			if (IOThreadPool != NULL) {
+				IOThreadPool->Destroy();
+				delete IOThreadPool;
+			}
+		};
+		const int32 NumFileThreads = IOThreadPool != NULL ? Params.NumIOThreads : Params.NumThreads;
+
+		//Every worker holds at most one chunk of the file it reads, and the file buffers get a quarter of the limit, leaving the rest for the job list, the manifest and the include cache
+		if (Params.MemoryLimitMB > 0) {
+			const int64 MemoryLimitBytes = (int64) Params.MemoryLimitMB * 1024 * 1024;
+			StreamingChunkSize = FMath::Clamp<int64>(MemoryLimitBytes / (4 * FMath::Max(NumFileThreads, 1)), 64 * 1024, 16 * 1024 * 1024);
+			UE_LOG(LogProjectGenerator, Display, TEXT("Memory limit is %d MB, files larger than %lld KB will be streamed"), Params.MemoryLimitMB, StreamingChunkSize / 1024);
+		}
+		
+		//Headers declaring multiple reflected types are split before anything else reads them, so the split headers go through the same rewriting as the rest of the files
+		if (Params.bSplitHeaders) {
+			FScopedGeneratorPhase HeaderSplittingPhase(Stats, TEXT("HeaderSplitting"));
+
+			//Split headers are named after their types, and must not clash with the other headers of the module since UHT names the generated headers the same way
+			TMap<FName, TSet<FString>> ModuleHeaderNames;
+			TMap<FName, TArray<int32>> ModuleHeaderJobIndices;
+			for (int32 JobIndex = 0; JobIndex < ModuleFileJobs.Num(); JobIndex++) {
+				const FModuleFileJob& FileJob = ModuleFileJobs[JobIndex];
+				if (FPaths::GetExtension(FileJob.SourceFilename) == TEXT("h")) {
+					ModuleHeaderNames.FindOrAdd(FileJob.ModuleName).Add(FPaths::GetBaseFilename(FileJob.SourceFilename));
+					ModuleHeaderJobIndices.FindOrAdd(FileJob.ModuleName).Add(JobIndex);
+				}
+			}
+			TArray<FName> SplitModuleNames;
+			ModuleHeaderJobIndices.GenerateKeyArray(SplitModuleNames);
+
+			//Modules are split in parallel, and the headers of the module one after another in the job order, so the split headers get the same names in every run
+			TArray<TArray<FModuleFileJob>> ModuleSplitFileJobs;
+			TArray<TArray<TPair<FString, FString>>> ModuleSplitObjectIncludePaths;
+			TArray<int32> ModuleHeadersSplit;
+			ModuleSplitFileJobs.SetNum(SplitModuleNames.Num());
+			ModuleSplitObjectIncludePaths.SetNum(SplitModuleNames.Num());
+			ModuleHeadersSplit.SetNumZeroed(SplitModuleNames.Num());
+
+			ExecuteParallelJobs(SplitModuleNames.Num(), NumFileThreads, IOThreadPool, [&](int32 ModuleIndex) {
+				const FName ModuleName = SplitModuleNames[ModuleIndex];
+				TSet<FString>& HeaderNames = ModuleHeaderNames.FindChecked(ModuleName);
+				const FString ModuleSourceDirectory = ModuleSourceDirectories.FindChecked(ModuleName.ToString()) / TEXT("");
+
+				for (const int32 JobIndex : ModuleHeaderJobIndices.FindChecked(ModuleName)) {
+					FModuleFileJob& FileJob = ModuleFileJobs[JobIndex];
+					TArray<uint8> SourceFileContents;
+					if (IsStreamedFile(FileJob.SourceFilename) || !FHeaderFileRewriter::LoadFileContents(FileJob.SourceFilename, SourceFileContents)) {
+						continue;
+					}
+					FString ModuleRelativePath = FileJob.SourceFilename;
+					FPaths::MakePathRelativeTo(ModuleRelativePath, *ModuleSourceDirectory);
+					const FString IncludeDirectory = FPaths::GetPath(FHeaderSplitter::GetModuleIncludePath(ModuleRelativePath));
+
+					TArray<FSplitHeaderFile> SplitHeaders;
+					TArray<uint8> RemainingContents;
+					if (!FHeaderSplitter::SplitHeader(FileJob.SourceFilename, SourceFileContents, IncludeDirectory, HeaderNames, SplitHeaders, RemainingContents)) {
+						continue;
+					}
+					FileJob.SplitContents = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(RemainingContents));
+					ModuleHeadersSplit[ModuleIndex]++;
+
+					//Watch mode only regenerates the split headers when the header they have been split from has changed
+					const bool bSourceFileChanged = Params.bOnlyChangedFiles && Params.ChangedSourceFiles.Contains(FPaths::ConvertRelativePathToFull(FileJob.SourceFilename));
+					
+					for (FSplitHeaderFile& SplitHeader : SplitHeaders) {
+						FModuleFileJob& SplitFileJob = ModuleSplitFileJobs[ModuleIndex].AddDefaulted_GetRef();
+						SplitFileJob.ModuleName = ModuleName;
+						SplitFileJob.SourceFilename = FPaths::GetPath(FileJob.SourceFilename) / SplitHeader.Filename;
+						SplitFileJob.TargetFilename = FPaths::GetPath(FileJob.TargetFilename) / SplitHeader.Filename;
+						SplitFileJob.bIsPublicHeader = FileJob.bIsPublicHeader;
+						SplitFileJob.bForceProcessing = bSourceFileChanged;
+						SplitFileJob.SplitContents = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(SplitHeader.Contents));
+
+						const FString SplitHeaderIncludePath = IncludeDirectory.IsEmpty() ? SplitHeader.Filename : IncludeDirectory / SplitHeader.Filename;
+						for (const FString& ObjectName : SplitHeader.ObjectNames) {
+							ModuleSplitObjectIncludePaths[ModuleIndex].Add(TPair<FString, FString>(ObjectName, SplitHeaderIncludePath));
+						}
+					}
+				}
+			});
+
+			int32 NumHeadersSplit = 0;
+			int32 NumSplitHeaders = 0;
+			for (int32 ModuleIndex = 0; ModuleIndex < SplitModuleNames.Num(); ModuleIndex++) {
+				for (const TPair<FString, FString>& SplitObjectIncludePath : ModuleSplitObjectIncludePaths[ModuleIndex]) {
+					IncludeResolver.AddSplitObject(SplitModuleNames[ModuleIndex].ToString(), SplitObjectIncludePath.Key, SplitObjectIncludePath.Value);
+				}
+				NumHeadersSplit += ModuleHeadersSplit[ModuleIndex];
+				NumSplitHeaders += ModuleSplitFileJobs[ModuleIndex].Num();
+				ModuleFileJobs.Append(MoveTemp(ModuleSplitFileJobs[ModuleIndex]));
+			}
+
+			//Headers of the carried over modules are not split again, so their objects are resolved to the split headers recorded by the run that has split them
+			if (Params.WatchState != NULL) {
+				for (const FString& ChangedModule : Params.ChangedModules) {
+					Params.WatchState->ModuleSplitObjectIncludePaths.Remove(ChangedModule);
+				}
+				for (const TPair<FString, TArray<TPair<FString, FString>>>& ModuleSplitObjects : Params.WatchState->ModuleSplitObjectIncludePaths) {
+					for (const TPair<FString, FString>& SplitObjectIncludePath : ModuleSplitObjects.Value) {
+						IncludeResolver.AddSplitObject(ModuleSplitObjects.Key, SplitObjectIncludePath.Key, SplitObjectIncludePath.Value);
+					}
+				}
+				for (int32 ModuleIndex = 0; ModuleIndex < SplitModuleNames.Num(); ModuleIndex++) {
+					Params.WatchState->ModuleSplitObjectIncludePaths.Add(SplitModuleNames[ModuleIndex].ToString(), MoveTemp(ModuleSplitObjectIncludePaths[ModuleIndex]));
+				}
+			}
+			UE_LOG(LogProjectGenerator, Display, TEXT("Split %d headers into %d headers of their reflected types"), NumHeadersSplit, NumSplitHeaders);
+		}
+
+		//Scan all of the headers for the include markers first, so the engine modules they reference can be loaded in one go
+		//Afterwards every include is served from the resolver cache, and the workers never have to wait for the game thread
+		{
+			FScopedGeneratorPhase DependencyScanPhase(Stats, TEXT("DependencyScan"));
+
+			TArray<TArray<FCrossModuleIncludeKey>> FileIncludeKeys;
+			FileIncludeKeys.SetNum(ModuleFileJobs.Num());
+		
+			ExecuteParallelJobs(ModuleFileJobs.Num(), NumFileThreads, IOThreadPool, [&](int32 JobIndex) {
+				FModuleFileJob& FileJob = ModuleFileJobs[JobIndex];
+				TArray<uint8> SourceFileContents;
+
+				//Source files carried over in the watch mode still need the forward declarations of their headers, so the headers are always scanned
+				FGeneratedFileRecord CarriedOverFileRecord;
+				if (!Params.bForwardDeclare && FindCarriedOverFileRecord(FileJob, CarriedOverFileRecord)) {
+					return;
+				}
+
+				if (!IsRewrittenSourceFile(FileJob.SourceFilename)) {
+					return;
+				}
+
+				TArray<FHeaderIncludeMarker> IncludeMarkers;
+				FHeaderFileScan SourceFileScan;
+				const bool bIsStreamedFile = !FileJob.SplitContents.IsValid() && IsStreamedFile(FileJob.SourceFilename) && FHeaderFileRewriter::ScanFileInChunks(FileJob.SourceFilename, StreamingChunkSize, SourceFileScan);
+				
+				if (bIsStreamedFile) {
+					IncludeMarkers = MoveTemp(SourceFileScan.IncludeMarkers);
+				} else if (LoadModuleFileContents(FileJob, SourceFileContents)) {
+					FHeaderFileRewriter::FindIncludeMarkers(FileJob.SourceFilename, SourceFileContents, IncludeMarkers);
+				}
+
+				//The same object is often referenced by multiple markers of the file, and only needs to be kept once
+				for (const FHeaderIncludeMarker& IncludeMarker : IncludeMarkers) {
+					FileIncludeKeys[JobIndex].AddUnique(IncludeMarker.IncludeKey);
+				}
+
+				//Usages of the referenced classes are only analyzed in the headers that have any markers at all, and are small enough to be converted into the string
+				if (Params.bForwardDeclare && IncludeMarkers.Num() && FPaths::GetExtension(FileJob.SourceFilename) == TEXT("h")) {
+					if (bIsStreamedFile) {
+						UE_LOG(LogProjectGenerator, Verbose, TEXT("Not forward declaring the classes of the streamed header %s"), *FileJob.SourceFilename);
+					} else {
+						const FUTF8ToTCHAR FileContentsConverter((const ANSICHAR*) SourceFileContents.GetData(), SourceFileContents.Num());
+						const FString FileContentsString(FileContentsConverter.Length(), FileContentsConverter.Get());
+						
+						for (const FHeaderIncludeMarker& IncludeMarker : IncludeMarkers) {
+							FString ClassName;
+							if (!FileJob.ForwardDeclarations.Contains(IncludeMarker.IncludeKey) && FHeaderFileRewriter::FindForwardDeclarableClass(FileContentsString, IncludeMarker.IncludeKey.ObjectName, ClassName)) {
+								FileJob.ForwardDeclarations.Add(IncludeMarker.IncludeKey, FString::Printf(TEXT("class %s;"), *ClassName));
+							}
+						}
+					}
+				}
+			});
+
+			//Includes can only be moved out of the header when it has the source file with the same name in the same module
+			if (Params.bForwardDeclare) {
+				TMap<FString, int32> SourceFileJobIndices;
+				for (int32 JobIndex = 0; JobIndex < ModuleFileJobs.Num(); JobIndex++) {
+					if (FPaths::GetExtension(ModuleFileJobs[JobIndex].SourceFilename) == TEXT("cpp")) {
+						SourceFileJobIndices.Add(ModuleFileJobs[JobIndex].ModuleName.ToString() / FPaths::GetBaseFilename(ModuleFileJobs[JobIndex].SourceFilename), JobIndex);
+					}
+				}
+
+				int32 NumForwardDeclarations = 0;
+				for (FModuleFileJob& FileJob : ModuleFileJobs) {
+					if (FileJob.ForwardDeclarations.Num() == 0) {
+						continue;
+					}
+					const int32* SourceFileJobIndex = SourceFileJobIndices.Find(FileJob.ModuleName.ToString() / FPaths::GetBaseFilename(FileJob.SourceFilename));
+					if (SourceFileJobIndex == NULL) {
+						FileJob.ForwardDeclarations.Reset();
+						continue;
+					}
+
+					FModuleFileJob& SourceFileJob = ModuleFileJobs[*SourceFileJobIndex];
+					for (const TPair<FCrossModuleIncludeKey, FString>& ForwardDeclaration : FileJob.ForwardDeclarations) {
+						SourceFileJob.MovedIncludes.AddUnique(ForwardDeclaration.Key);
+					}
+					SourceFileJob.bForceProcessing |= Params.bOnlyChangedFiles && Params.ChangedSourceFiles.Contains(FPaths::ConvertRelativePathToFull(FileJob.SourceFilename));
+					NumForwardDeclarations += FileJob.ForwardDeclarations.Num();
+				}
+				UE_LOG(LogProjectGenerator, Display, TEXT("Replacing %d includes of the headers with the forward declarations"), NumForwardDeclarations);
+			}
+
+			//Merged in the job order, so the header reported for the unresolved object is always the same one
+			TMap<FCrossModuleIncludeKey, FString> ReferencedObjects;
+			TSet<FString> ReferencedModules;
+		
+			for (int32 JobIndex = 0; JobIndex < ModuleFileJobs.Num(); JobIndex++) {
+				for (const FCrossModuleIncludeKey& IncludeKey : FileIncludeKeys[JobIndex]) {
+					if (!ReferencedObjects.Contains(IncludeKey)) {
+						ReferencedObjects.Add(IncludeKey, ModuleFileJobs[JobIndex].SourceFilename);
+						ReferencedModules.Add(IncludeKey.ModuleName);
+					}
+				}
+			}
+			UE_LOG(LogProjectGenerator, Display, TEXT("Header files reference %d distinct objects from %d modules"), ReferencedObjects.Num(), ReferencedModules.Num());
+
+			IncludeResolver.PrepareIncludes(ReferencedObjects, ReferencedModules);
+		}
+
+		//Many modules share the same few directories, so each of them is created once upfront instead of for every file written into it
+		{
+			FScopedGeneratorPhase DirectoriesPhase(Stats, TEXT("Directories"));
+			
+			TSet<FString> TargetDirectories;
+			for (const FModuleFileJob& FileJob : ModuleFileJobs) {
+				TargetDirectories.Add(FPaths::GetPath(FileJob.TargetFilename));
+			}
+			for (const FString& TargetDirectory : TargetDirectories) {
+				PlatformFile.CreateDirectoryTree(*TargetDirectory);
+			}
+			Stats.DirectoriesCreated.Set(TargetDirectories.Num());
+		}
+
+		//Copy and rewrite the files of the collected modules. Every file is handled independently, so the order does not affect the output
+		UE_LOG(LogProjectGenerator, Display, TEXT("Processing %d module files using %d threads"), ModuleFileJobs.Num(), NumFileThreads);
+		{
+			FScopedGeneratorPhase ModuleFilesPhase(Stats, TEXT("ModuleFiles"));
+			ExecuteParallelJobs(ModuleFileJobs.Num(), NumFileThreads, IOThreadPool, [&](int32 JobIndex) {
+				ProcessModuleFile(ModuleFileJobs[JobIndex]);
+			});
+		}
+		UE_LOG(LogProjectGenerator, Display, TEXT("Handled %d plugin modules and %d game modules"), PluginModulesCopied, GameModulesCopied);
+		IncludeResolver.LogCacheStatistics();
+
+		//Engine modules are loaded during the dependency scan, so their loading time is a part of that phase
+		//Jobs running at the same time all update the counters of the shared resolver, so the difference would include the work of the other jobs
+		if (Session.bRunningConcurrentJobs) {
+			Stats.bHasIncludeResolverCounters = false;
+		} else {
+			Stats.AddPhaseTime(TEXT("EngineModuleLoading"), IncludeResolver.GetModuleLoadingSeconds() - InitialModuleLoadingSeconds);
+			Stats.ModulesForceLoaded.Set(IncludeResolver.GetModulesForceLoaded() - InitialModulesForceLoaded);
+			Stats.IncludeCacheHits.Set(IncludeResolver.GetCacheHits() - InitialCacheHits);
+			Stats.IncludeCacheMisses.Set(IncludeResolver.GetCacheMisses() - InitialCacheMisses);
+		}
+
+		//Remove the files generated by the previous run which sources no longer exist in the header dump
+		if (Params.bIncremental) {
+			const TArray<FString> StaleFiles = PreviousManifest.GetFilesMissingFrom(NewManifest);
+			for (const FString& StaleRelativeFilename : StaleFiles) {
+				PlatformFile.DeleteFile(*(Params.OutputDirectory / StaleRelativeFilename));
+			}
+			UE_LOG(LogProjectGenerator, Display, TEXT("Skipped %lld unchanged files and removed %d stale files"), Stats.FilesSkipped.GetValue(), StaleFiles.Num());
+		}
+		if (!NewManifest.Save(ManifestFilePath)) {
+			UE_LOG(LogProjectGenerator, Warning, TEXT("Failed to save generated file manifest to %s"), *ManifestFilePath);
+		}
+
+		//Watch mode only sees the includes of the changed files, so it keeps the files generated by the last full run
+		if (bCollectDependencyGraph && !Params.bOnlyChangedFiles) {
+			FScopedGeneratorPhase BuildSettingsPhase(Stats, TEXT("BuildSettings"));
+
+			//Engine plugin modules can only be referenced because the plugins are kept enabled in the project file
+			TSet<FString> EnginePluginModules;
+			for (const TPair<FString, TSet<FString>>& EnginePlugin : EnginePlugins) {
+				EnginePluginModules.Append(EnginePlugin.Value);
+			}
+			auto IsEngineModule = [&](const FString& ModuleName) {
+				return EngineModules.Contains(ModuleName) || EnginePluginModules.Contains(ModuleName);
+			};
+			auto IsDependencyAvailable = [&](const FString& ModuleName) {
+				return IsEngineModule(ModuleName) || AllGameModulesProcessed.Contains(ModuleName);
+			};
+
+			//Only the game modules can form the cycles, engine modules never depend on them
+			const TArray<TArray<FString>> DependencyCycles = DependencyGraph.FindCycles([&](const FString& ModuleName) {
+				return AllGameModulesProcessed.Contains(ModuleName);
+			});
+			for (const TArray<FString>& DependencyCycle : DependencyCycles) {
+				UE_LOG(LogProjectGenerator, Warning, TEXT("Circular dependency between the modules %s, it needs to be broken or declared through CircularlyReferencedDependentModules"), *FString::Join(DependencyCycle, TEXT(", ")));
+			}
+
+			if (!Params.DependencyGraphPath.IsEmpty() && !DependencyGraph.Save(Params.DependencyGraphPath, DependencyCycles)) {
+				UE_LOG(LogProjectGenerator, Warning, TEXT("Failed to save module dependency graph to %s"), *Params.DependencyGraphPath);
+			}
+
+			for (const TPair<FString, FString>& ModuleTargetDirectory : ModuleTargetDirectories) {
+				const FString& ModuleName = ModuleTargetDirectory.Key;
+				const FString BuildFileName = ModuleName + TEXT(".Build.cs");
+				const FString TargetBuildFilename = ModuleTargetDirectory.Value / BuildFileName;
+				
+				if (Params.bGeneratePCH) {
+					//Build rules of the dump are updated in place, and only generated from scratch when the module does not have any
+					const FString SourceBuildFilename = ModuleSourceDirectories.FindChecked(ModuleName) / BuildFileName;
+					FString SourceBuildFileContents;
+					const bool bHasSourceBuildFile = FFileHelper::LoadFileToString(SourceBuildFileContents, *SourceBuildFilename);
+
+					FString PCHFileContents;
+					FString BuildFileContents;
+					ModuleBuildSettings.GenerateModuleFiles(ModuleName, DependencyGraph, IsDependencyAvailable, IsEngineModule, bHasSourceBuildFile ? &SourceBuildFileContents : NULL, PCHFileContents, BuildFileContents);
+
+					const FString PCHFilename = ModuleTargetDirectory.Value / FModuleBuildSettings::GetPCHFileName(ModuleName);
+					PlatformFile.CreateDirectoryTree(*FPaths::GetPath(PCHFilename));
+					bGeneratedFilesSaved &= SaveGeneratedFile(PCHFileContents, PCHFilename);
+					bGeneratedFilesSaved &= SaveGeneratedFile(BuildFileContents, TargetBuildFilename);
+					
+				} else if (Params.bPruneBuildDependencies) {
+					//Build rules without any dependency lists are carried over as they are
+					const FString SourceBuildFilename = ModuleSourceDirectories.FindChecked(ModuleName) / BuildFileName;
+					FString BuildFileContents;
+					if (!FFileHelper::LoadFileToString(BuildFileContents, *SourceBuildFilename)) {
+						continue;
+					}
+					FString PrunedBuildFileContents;
+					if (!FModuleBuildSettings::PruneBuildFileDependencies(ModuleName, BuildFileContents, DependencyGraph, IsDependencyAvailable, PrunedBuildFileContents)) {
+						UE_LOG(LogProjectGenerator, Warning, TEXT("Build rules %s do not declare any dependency lists, leaving them as they are"), *SourceBuildFilename);
+						PrunedBuildFileContents = BuildFileContents;
+					}
+					bGeneratedFilesSaved &= SaveGeneratedFile(PrunedBuildFileContents, TargetBuildFilename);
+				}
+			}
+			if (Params.bGeneratePCH || Params.bPruneBuildDependencies) {
+				UE_LOG(LogProjectGenerator, Display, TEXT("%s build rules of %d modules, found %d dependency cycles"), Params.bGeneratePCH ? TEXT("Generated") : TEXT("Pruned"), ModuleTargetDirectories.Num(), DependencyCycles.Num());
+			}
+		}
+
+		//Headers are checked once everything they can include, including the precompiled headers, has been written
+		if (Params.bValidateSyntax) {
+			FScopedGeneratorPhase SyntaxValidationPhase(Stats, TEXT("SyntaxValidation"));
+
+			FSyntaxValidationSettings ValidationSettings;
+			ValidationSettings.CompilerName = Params.SyntaxCompiler;
+			ValidationSettings.CompilerArguments = Params.SyntaxCompilerArguments;
+			ValidationSettings.OutputDirectory = Params.OutputDirectory;
+
+			//Private directories of the other modules are visible too, which does not matter for the syntax check
+			TArray<FString> GeneratedModuleNames;
+			ModuleTargetDirectories.GetKeys(GeneratedModuleNames);
+			GeneratedModuleNames.Sort();
+			for (const FString& ModuleName : GeneratedModuleNames) {
+				const FString ModuleDirectory = FPaths::ConvertRelativePathToFull(ModuleTargetDirectories.FindChecked(ModuleName));
+				ValidationSettings.IncludeDirectories.Add(ModuleDirectory);
+				for (const TCHAR* IncludeDirectoryName : {TEXT("Public"), TEXT("Classes"), TEXT("Private")}) {
+					if (PlatformFile.DirectoryExists(*(ModuleDirectory / IncludeDirectoryName))) {
+						ValidationSettings.IncludeDirectories.Add(ModuleDirectory / IncludeDirectoryName);
+					}
+				}
+			}
+			//Engine does not change during the session, so its include directories are only walked by the first job validating the syntax
+			if (Session.EngineIncludeDirectories.Num() == 0) {
+				FSyntaxValidator::DiscoverEngineIncludeDirectories(Session.EngineIncludeDirectories);
+			}
+			ValidationSettings.IncludeDirectories.Append(Session.EngineIncludeDirectories);
+
+			ValidationSettings.ModuleNames = GeneratedModuleNames;
+			ValidationSettings.ModuleNames.Append(EngineModules.Array());
+			for (const TPair<FString, TSet<FString>>& EnginePlugin : EnginePlugins) {
+				ValidationSettings.ModuleNames.Append(EnginePlugin.Value.Array());
+			}
+
+			//Hashes of the headers have already been recorded into the manifest when they were written
+			TArray<FSyntaxValidationFile> ValidationFiles;
+			for (const FModuleFileJob& FileJob : ModuleFileJobs) {
+				FString RelativeTargetFilename = FileJob.TargetFilename;
+				FPaths::MakePathRelativeTo(RelativeTargetFilename, *OutputDirectoryWithSlash);
+
+				FGeneratedFileRecord FileRecord;
+				if (FPaths::GetExtension(FileJob.TargetFilename) == TEXT("h") && NewManifest.FindFile(RelativeTargetFilename, FileRecord)) {
+					FSyntaxValidationFile& ValidationFile = ValidationFiles.AddDefaulted_GetRef();
+					ValidationFile.ModuleName = FileJob.ModuleName.ToString();
+					ValidationFile.Filename = FPaths::ConvertRelativePathToFull(FileJob.TargetFilename);
+					ValidationFile.RelativeFilename = RelativeTargetFilename;
+					ValidationFile.ContentHash = FileRecord.OutputHash;
+				}
+			}
+			for (const TPair<FString, TArray<FString>>& ModuleFiles : CarriedOverModuleFiles) {
+				for (const FString& RelativeTargetFilename : ModuleFiles.Value) {
+					FGeneratedFileRecord FileRecord;
+					if (FPaths::GetExtension(RelativeTargetFilename) == TEXT("h") && NewManifest.FindFile(RelativeTargetFilename, FileRecord)) {
+						FSyntaxValidationFile& ValidationFile = ValidationFiles.AddDefaulted_GetRef();
+						ValidationFile.ModuleName = ModuleFiles.Key;
+						ValidationFile.Filename = FPaths::ConvertRelativePathToFull(Params.OutputDirectory / RelativeTargetFilename);
+						ValidationFile.RelativeFilename = RelativeTargetFilename;
+						ValidationFile.ContentHash = FileRecord.OutputHash;
+					}
+				}
+			}
+
+			FSyntaxValidator SyntaxValidator(ValidationSettings);
+			if (SyntaxValidator.Prepare(ValidationFiles)) {
+				//Workers only wait for the compiler processes, so there is one for every core regardless of the thread count
+				const int32 NumCompilerProcesses = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+				FQueuedThreadPool* CompilerThreadPool = FQueuedThreadPool::Allocate();
+				verify(CompilerThreadPool->Create(NumCompilerProcesses, 128 * 1024));
+
+				UE_LOG(LogProjectGenerator, Display, TEXT("Checking syntax of %d out of %d generated headers using %d compiler processes"), SyntaxValidator.GetNumPendingFiles(), ValidationFiles.Num(), NumCompilerProcesses);
+				ExecuteParallelJobs(SyntaxValidator.GetNumPendingFiles(), NumCompilerProcesses, CompilerThreadPool, [&](int32 PendingFileIndex) {
+					SyntaxValidator.CheckHeader(PendingFileIndex);
+				});
+				CompilerThreadPool->Destroy();
+				delete CompilerThreadPool;
+
+				SyntaxValidator.Finish();
+			}
+		}
+	}
+
+	//Carry over the descriptors and sanitize them to only reference what we have actually generated
+	{
+		FScopedGeneratorPhase DescriptorsPhase(Stats, TEXT("Descriptors"));
+		
+		TSet<FString> AllGamePluginsProcessed;
+	
+		//Carry over uplugin files and sanitize them to only include modules that we have carried over
+		for (FPluginManifestEntry& ManifestEntry : Params.PluginManifest.Contents) {
+			const FString PluginName = FPaths::GetBaseFilename(ManifestEntry.File);
+
+			//Skip engine plugins, plugins for which we do not have the implied paths and plugins outside of the module selection
+			if (EnginePlugins.Contains(PluginName) || !GameImpliedPluginFileLocations.Contains(PluginName) || UnselectedPlugins.Contains(PluginName)) {
+				continue;
+			}
+
+			const FString NewPluginFileLocation = GameImpliedPluginFileLocations.FindChecked(PluginName);
+			FPluginDescriptor NewPluginDescriptor = ManifestEntry.Descriptor;
+
+			//Cleanup any modules that we have not copied
+			NewPluginDescriptor.Modules.RemoveAll([&](const FModuleDescriptor& ModuleDescriptor) {
+				const FString ModuleName = ModuleDescriptor.Name.ToString();
+			
+				//Keep engine module references, even if we have not copied them
+				return !EngineModules.Contains(ModuleName) &&
+					!AllGameModulesProcessed.Contains(ModuleName);
+			});
+
+			//Cleanup any plugin dependencies that physically do not exist in the project
+			NewPluginDescriptor.Plugins.RemoveAll([&](const FPluginReferenceDescriptor& PluginDescriptor) {
+				const FString ReferencedPluginName = PluginDescriptor.Name;
+			
+				return (!GameImpliedPluginFileLocations.Contains(ReferencedPluginName) &&
+					!EnginePlugins.Contains(ReferencedPluginName)) || UnselectedPlugins.Contains(ReferencedPluginName);
+			});
+
+			GenerationPlan.AddPluginDescriptor(PluginName, NewPluginFileLocation, NewPluginDescriptor);
+			AllGamePluginsProcessed.Add(PluginName);
+
+			if (Params.bDryRun) {
+				continue;
+			}
+
+			//Make sure the underlying directory exists
+			PlatformFile.CreateDirectoryTree(*FPaths::GetPath(NewPluginFileLocation));
+		
+			FString PluginFileContents;
+			NewPluginDescriptor.Write(PluginFileContents);
+			bGeneratedFilesSaved &= SaveGeneratedFile(PluginFileContents, NewPluginFileLocation);
+		}
+
+		//Sanitize the project file
+		FProjectDescriptor NewProjectDescriptor = Params.ProjectFile;
+
+		//Remove all of the modules that we have not copied
+		NewProjectDescriptor.Modules.RemoveAll([&](const FModuleDescriptor& ModuleDescriptor) {
+			const FString ModuleName = ModuleDescriptor.Name.ToString();
+			
+			//Keep engine module references, even if we have not copied them
+			return !EngineModules.Contains(ModuleName) &&
+				!AllGameModulesProcessed.Contains(ModuleName);
+		});
+
+		//Remove references to the plugins that we have not actually copied
+		NewProjectDescriptor.Plugins.RemoveAll([&](FPluginReferenceDescriptor& PluginReference) {
+			const FString PluginName = PluginReference.Name;
+
+			//Strip out whitelisted platforms that we do not know about, Stadia in particular
+			//TODO seems to be engine patch to support stadia target? Is it a backport from UE4.26?
+			PluginReference.WhitelistPlatforms.Remove(TEXT("Stadia"));
+		
+			//Keep engine plugins references
+			return !EnginePlugins.Contains(PluginName) &&
+				!AllGamePluginsProcessed.Contains(PluginName);
+		});
+
+		//Force references to the engine modules that do not exist in the engine now, in the sorted order to keep the project file stable
+		TArray<FString> SortedForcedEngineModules = EngineModulesForcedToBeGameModules.Array();
+		SortedForcedEngineModules.Sort();
+		
+		for (const FString& ForcedEngineModule : SortedForcedEngineModules) {
+			FModuleDescriptor NewModuleDescriptor{};
+		
+			NewModuleDescriptor.Name = *ForcedEngineModule;
+			NewModuleDescriptor.Type = EHostType::Runtime;
+			NewModuleDescriptor.LoadingPhase = ELoadingPhase::Default;
+		
+			NewProjectDescriptor.Modules.Add(NewModuleDescriptor);
+		}
+
+		const FString ResultFilePath = Params.OutputDirectory / Params.ProjectName += TEXT(".uproject");
+		const FString TargetFileName = ProjectSourceDir / FString::Printf(TEXT("%sEditor.Target.cs"), *Params.ProjectName);
+		GenerationPlan.SetProjectDescriptor(ResultFilePath, NewProjectDescriptor);
+		GenerationPlan.SetTargetModules(TargetFileName, LooseGameModuleNames);
+
+		if (!Params.bDryRun) {
+			//Save the new project file at the destination path
+			FString ProjectFileContents;
+			const TSharedRef<TJsonWriter<>> ProjectFileWriter = TJsonWriterFactory<>::Create(&ProjectFileContents);
+			NewProjectDescriptor.Write(ProjectFileWriter.Get(), FPaths::GetPath(ResultFilePath));
+			ProjectFileWriter->Close();
+			bGeneratedFilesSaved &= SaveGeneratedFile(ProjectFileContents, ResultFilePath);
+
+			//Generate the editor target file
+			bGeneratedFilesSaved &= GenerateTargetFile(Params, TargetFileName, LooseGameModuleNames);
+		}
+	}
+
+	if (Params.bDryRun) {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Dry run: %d plugin modules, %d game modules, %d forced game modules, %d engine modules and %d engine plugin modules skipped, %d modules discarded, %d modules not selected"),
+			GenerationPlan.GetNumModules(EModuleClassification::PluginModule), GenerationPlan.GetNumModules(EModuleClassification::GameModule),
+			GenerationPlan.GetNumModules(EModuleClassification::ForcedGameModule), GenerationPlan.GetNumModules(EModuleClassification::EngineModule),
+			GenerationPlan.GetNumModules(EModuleClassification::EnginePluginModule), GenerationPlan.GetNumModules(EModuleClassification::DiscardedModule),
+			GenerationPlan.GetNumModules(EModuleClassification::UnselectedModule));
+	} else {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Wrote project data to %s"), *Params.OutputDirectory);
+	}
+
+	//Plan is printed into the log when running dry without the plan file, so it is still visible in the CI output
+	if (!Params.PlanFilePath.IsEmpty()) {
+		if (!GenerationPlan.Save(Params.PlanFilePath)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Failed to save generation plan to %s"), *Params.PlanFilePath);
+			return 1;
+		}
+	} else if (Params.bDryRun) {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Generation plan:\n%s"), *GenerationPlan.ToJsonString());
+	}
+	Stats.LogSummary();
+
+	//Only the file buffers are bounded by the limit, so going over it means that the rest of the generation state has outgrown it
+	if (Params.MemoryLimitMB > 0 && FPlatformMemory::GetStats().PeakUsedPhysical > (uint64) Params.MemoryLimitMB * 1024 * 1024) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Peak working set of %llu MB exceeds the memory limit of %d MB"), (uint64) FPlatformMemory::GetStats().PeakUsedPhysical / (1024 * 1024), Params.MemoryLimitMB);
+	}
+
+	if (!Params.StatsFilePath.IsEmpty() && !Stats.SaveReport(Params.StatsFilePath)) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Failed to save generation stats to %s"), *Params.StatsFilePath);
+	}
+	if (!bGeneratedFilesSaved) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Some of the generated files could not be saved into %s"), *Params.OutputDirectory);
+		return 1;
+	}
+	return 0;
+}
+
+bool FProjectGenerator::GenerateTargetFile(FCommandletRunParams& Params, const FString& TargetFileName, const TSet<FString>& GameModuleNames) {
+	TArray<FString> TargetFileLines;
+
+	TargetFileLines.Add(TEXT("using UnrealBuildTool;"));
+	TargetFileLines.Add(TEXT(""));
+	TargetFileLines.Add(FString::Printf(TEXT("public class %sEditorTarget : TargetRules {"), *Params.ProjectName));
+	TargetFileLines.Add(FString::Printf(TEXT("	public %sEditorTarget(TargetInfo Target) : base(Target) {"), *Params.ProjectName));
+
+	TargetFileLines.Add(TEXT("		Type = TargetType.Editor;"));
+	TargetFileLines.Add(TEXT("		DefaultBuildSettings = BuildSettingsVersion.V2;"));
+
+	//Module names are sorted so the file does not change between the runs with the same modules
+	TArray<FString> SortedGameModuleNames = GameModuleNames.Array();
+	SortedGameModuleNames.Sort();
+
+	TargetFileLines.Add(TEXT("		ExtraModuleNames.AddRange(new string[] {"));
+	for (const FString& GameModuleName : SortedGameModuleNames) {
+		TargetFileLines.Add(FString::Printf(TEXT("			\"%s\","), *GameModuleName));
+	}
+	TargetFileLines.Add(TEXT("		});"));
+	
+	TargetFileLines.Add(TEXT("	}"));
+	TargetFileLines.Add(TEXT("}"));
+
+	const FString TargetFileContents = FString::Join(TargetFileLines, LINE_TERMINATOR) + LINE_TERMINATOR;
+	return SaveGeneratedFile(TargetFileContents, TargetFileName);
+}
+
+bool FProjectGenerator::SaveGeneratedFile(const FString& FileContents, const FString& Filename) {
+	//Generated files always use CRLF line endings and UTF-8 without BOM, so they are the same regardless of the platform and contents
+	FString NormalizedFileContents = FileContents.Replace(TEXT("\r\n"), TEXT("\n"));
+	NormalizedFileContents.ReplaceInline(TEXT("\n"), TEXT("\r\n"), ESearchCase::CaseSensitive);
+
+	const FTCHARToUTF8 FileContentsUTF8(*NormalizedFileContents);
+	TArray<uint8> FileBytes;
+	FileBytes.Append((const uint8*) FileContentsUTF8.Get(), FileContentsUTF8.Length());
+
+	//Keep the file and its timestamp intact when its contents have not changed, so UBT and the build cache do not consider it changed
+	TArray<uint8> ExistingFileBytes;
+	if (FFileHelper::LoadFileToArray(ExistingFileBytes, *Filename, FILEREAD_Silent) && ExistingFileBytes == FileBytes) {
+		return true;
+	}
+	if (!FFileHelper::SaveArrayToFile(FileBytes, *Filename)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Failed to save generated file %s"), *Filename);
+		return false;
+	}
+	return true;
+}
+
+
+void FProjectGenerator::InitializeSession(bool bRefreshEngineCache, FProjectGeneratorSession& OutSession) {
+	//Collect a list of all engine modules and plugins once, all of the jobs in the session compare against it
+	//Include resolver depends on the way the generator is being run, so it is left for the caller to create
+	const double DiscoveryStartTime = FPlatformTime::Seconds();
+	{
+		FScopedGeneratorTraceEvent DiscoveryTraceEvent(TEXT("EngineDiscovery"));
+		DiscoverEngineContents(bRefreshEngineCache, OutSession.EngineSnapshot);
+	}
+	OutSession.EngineDiscoverySeconds = FPlatformTime::Seconds() - DiscoveryStartTime;
+
+	UE_LOG(LogProjectGenerator, Display, TEXT("Found %d engine plugins and %d engine modules in %.2f seconds"), OutSession.EngineSnapshot.EnginePlugins.Num(), OutSession.EngineSnapshot.EngineModules.Num(), OutSession.EngineDiscoverySeconds);
+}
+
+void FProjectGenerator::DiscoverEngineSourceModules(const FString& SourceSubdirectory, TSet<FString>& OutModulesFound) {
+	DiscoverModules(FPaths::EngineSourceDir() / SourceSubdirectory, OutModulesFound);
+}
+
+void FProjectGenerator::DiscoverEngineContents(bool bRefreshEngineCache, FEngineDiscoverySnapshot& OutSnapshot) {
+	//Walking the whole engine tree is slow, so reuse the results of the previous run as long as the engine has not changed
+	const FString SnapshotFilePath = FEngineDiscoveryCache::GetSnapshotFilePath();
+	const FString EngineFingerprint = FEngineDiscoveryCache::ComputeEngineFingerprint();
+
+	if (!bRefreshEngineCache && FEngineDiscoveryCache::LoadSnapshot(SnapshotFilePath, EngineFingerprint, OutSnapshot)) {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Using cached engine discovery snapshot %s"), *SnapshotFilePath);
+		return;
+	}
+
+	DiscoverPlugins(FPaths::EnginePluginsDir(), OutSnapshot.EnginePlugins);
+	DiscoverModules(FPaths::EngineSourceDir(), OutSnapshot.EngineModules);
+
+	if (!FEngineDiscoveryCache::SaveSnapshot(SnapshotFilePath, EngineFingerprint, OutSnapshot)) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Failed to save engine discovery snapshot to %s"), *SnapshotFilePath);
+	}
+}
+
+void FProjectGenerator::DiscoverPlugins(const FString& PluginDirectory, TMap<FString, TSet<FString>>& OutPluginsFound) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	//Name and directory of the plugins found during the walk, their modules are discovered afterwards
+	typedef TArray<TPair<FString, FString>> FFoundPluginArray;
+	FFoundPluginArray PluginsFound;
+
+	WalkDirectoryTreeParallel<FFoundPluginArray>(PluginDirectory, [&](const FString& Directory, TArray<FString>& OutSubDirectories, FFoundPluginArray& OutPluginsInDirectory) {
+		PlatformFile.IterateDirectory(*Directory, [&](const TCHAR* Filename, bool bIsDirectory) {
+			//Only interested in actual directories
+			if (bIsDirectory) {
+				//Check whenever the plugin file is present in the directory
+				const FString DirectoryName = FPaths::GetBaseFilename(Filename);
+				const FString PluginFilePath = FString(Filename) / DirectoryName += TEXT(".uplugin");
+
+				//Plugin file has been found at that directory, record it and do not descend into it
+				if (PlatformFile.FileExists(*PluginFilePath)) {
+					OutPluginsInDirectory.Add(TPair<FString, FString>(DirectoryName, Filename));
+					return true;
+				}
+				//Otherwise recursively iterate the directory, unless it's Saved
+				if (DirectoryName != TEXT("Saved")) {
+					OutSubDirectories.Add(Filename);
+				}
+			}
+			return true;
+		});
+	}, [&](FFoundPluginArray& PluginsInDirectory) {
+		PluginsFound.Append(MoveTemp(PluginsInDirectory));
+	});
+
+	//Record modules that belong to the plugins, each plugin is walked in parallel too
+	TArray<TSet<FString>> PluginModules;
+	PluginModules.SetNum(PluginsFound.Num());
+
+	ParallelFor(PluginsFound.Num(), [&](int32 PluginIndex) {
+		const FString PluginSourceDir = PluginsFound[PluginIndex].Value / TEXT("Source");
+
+		if (PlatformFile.DirectoryExists(*PluginSourceDir)) {
+			DiscoverModules(PluginSourceDir, PluginModules[PluginIndex]);
+		}
+	});
+
+	for (int32 PluginIndex = 0; PluginIndex < PluginsFound.Num(); PluginIndex++) {
+		OutPluginsFound.Add(PluginsFound[PluginIndex].Key, MoveTemp(PluginModules[PluginIndex]));
+	}
+}
+
+void FProjectGenerator::DiscoverModules(const FString& SourceDirectory, TSet<FString>& OutModulesFound) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	WalkDirectoryTreeParallel<TArray<FString>>(SourceDirectory, [&](const FString& Directory, TArray<FString>& OutSubDirectories, TArray<FString>& OutModulesInDirectory) {
+		//Check whenever the module build file is present in the directory
+		const FString DirectoryName = FPaths::GetBaseFilename(Directory);
+
+		//Quit directory immediately if it's Saved or Intermediate
+		if (DirectoryName == TEXT("Saved") || DirectoryName == TEXT("Intermediate")) {
+			return;
+		}
+		
+		TArray<FString> SubDirectoryPaths;
+
+		PlatformFile.IterateDirectory(*Directory, [&](const TCHAR* InnerFilename, bool bIsDirectoryInner) {
+			const FString InnerFilenameString = FString(InnerFilename);
+			if (bIsDirectoryInner) {
+				SubDirectoryPaths.Add(InnerFilenameString);
+				
+			} else if (InnerFilenameString.EndsWith(TEXT(".Build.cs"))) {
+				const FString BaseFilename = FPaths::GetBaseFilename(InnerFilenameString);
+				const FString ModuleName = BaseFilename.Mid(0, BaseFilename.Len() - 6);
+				
+				OutModulesInDirectory.Add(ModuleName);
+			}
+			return true;
+		});
+
+		//Module build file has been found at that directory, we do not consider any sub-directories
+		if (OutModulesInDirectory.Num() == 0) {
+			OutSubDirectories = MoveTemp(SubDirectoryPaths);
+		}
+	}, [&](TArray<FString>& ModulesInDirectory) {
+		OutModulesFound.Append(ModulesInDirectory);
+	});
+}
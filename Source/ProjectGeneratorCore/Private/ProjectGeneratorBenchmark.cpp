@@ -0,0 +1,294 @@
+#include "ProjectGeneratorBenchmark.h"
+#include "ProjectGenerator.h"
+#include "ProjectGeneratorSession.h"
+#include "PluginDescriptor.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+
+const TCHAR* FProjectGeneratorBenchmark::Usage = TEXT("-Benchmark [-BenchmarkDir=<Dir>] [-ModuleCount=<N>] [-PluginCount=<N>] [-FilesPerModule=<N>] [-LinesPerFile=<N>] [-MarkerDensity=<Fraction>] [-EngineMarkerWeight=<N>] [-GameMarkerWeight=<N>] [-MissingMarkerWeight=<N>] [-Seed=<N>] [-Iterations=<N>] [-BenchmarkReport=<ReportFile>]");
+
+static const TCHAR* SyntheticProjectName = TEXT("BenchmarkGame");
+
+//Commonly referenced engine objects, so the engine markers exercise the same modules real dumps do
+static const TCHAR* SyntheticEngineObjects[][2] = {
+	{TEXT("CoreUObject"), TEXT("Object")},
+	{TEXT("Engine"), TEXT("Actor")},
+	{TEXT("Engine"), TEXT("ActorComponent")},
+	{TEXT("Engine"), TEXT("SceneComponent")},
+	{TEXT("Engine"), TEXT("Pawn")},
+	{TEXT("Engine"), TEXT("Character")},
+	{TEXT("Engine"), TEXT("PlayerController")},
+	{TEXT("Engine"), TEXT("GameModeBase")},
+	{TEXT("Engine"), TEXT("DataAsset")},
+	{TEXT("Engine"), TEXT("BlueprintFunctionLibrary")},
+	{TEXT("UMG"), TEXT("UserWidget")},
+	{TEXT("GameplayTags"), TEXT("GameplayTagContainer")},
+};
+
+//Missing objects are drawn from a small pool, so the resolver warnings stay readable
+static const int32 NumSyntheticMissingObjects = 16;
+
+static const TCHAR* SyntheticHeaderLines[] = {
+	TEXT("	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(AllowPrivateAccess=true))"),
+	TEXT("	float PropertyValue;"),
+	TEXT("	UFUNCTION(BlueprintCallable, Category=\"Benchmark\")"),
+	TEXT("	void ExecuteFunction(int32 Argument, const FString& Name);"),
+	TEXT("	UPROPERTY(VisibleAnywhere, Transient)"),
+	TEXT("	TArray<UObject*> ReferencedObjects;"),
+	TEXT(""),
+};
+
+static FString GetSyntheticModuleName(int32 ModuleIndex) {
+	return FString::Printf(TEXT("BenchmarkModule%d"), ModuleIndex);
+}
+
+static FString GetSyntheticObjectName(int32 ModuleIndex, int32 FileIndex) {
+	return FString::Printf(TEXT("BenchmarkModule%dObject%d"), ModuleIndex, FileIndex);
+}
+
+//First modules belong to one plugin each, the rest are the game modules listed in the project file
+static FString GetSyntheticPluginName(int32 PluginIndex) {
+	return FString::Printf(TEXT("BenchmarkPlugin%d"), PluginIndex);
+}
+
+bool FProjectGeneratorBenchmark::SynthesizeHeaderDump(const FSyntheticHeaderDumpParams& DumpParams, const FString& BenchmarkDirectory, FSyntheticHeaderDump& OutHeaderDump) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	OutHeaderDump.HeaderRoot = BenchmarkDirectory / TEXT("HeaderDump");
+	OutHeaderDump.ProjectFilePath = BenchmarkDirectory / FString::Printf(TEXT("%s.uproject"), SyntheticProjectName);
+	OutHeaderDump.PluginManifestPath = BenchmarkDirectory / FString::Printf(TEXT("%s.upluginmanifest"), SyntheticProjectName);
+
+	//Dump of the previous run may have a different shape, so it is always generated from scratch
+	PlatformFile.DeleteDirectoryRecursively(*OutHeaderDump.HeaderRoot);
+	if (!PlatformFile.CreateDirectoryTree(*OutHeaderDump.HeaderRoot)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Failed to create synthetic header dump directory %s"), *OutHeaderDump.HeaderRoot);
+		return false;
+	}
+
+	const int32 NumPlugins = FMath::Min(DumpParams.NumPlugins, DumpParams.NumModules);
+	const int32 TotalMarkerWeight = FMath::Max(DumpParams.EngineMarkerWeight + DumpParams.GameMarkerWeight + DumpParams.MissingMarkerWeight, 1);
+
+	//Every module has its own random stream, so the contents do not depend on the order the modules are generated in
+	TArray<int64> ModuleBytes;
+	TArray<int32> ModuleMarkers;
+	ModuleBytes.SetNumZeroed(DumpParams.NumModules);
+	ModuleMarkers.SetNumZeroed(DumpParams.NumModules);
+	FThreadSafeBool bWriteFailed;
+
+	ParallelFor(DumpParams.NumModules, [&](int32 ModuleIndex) {
+		FRandomStream RandomStream(DumpParams.Seed * 7919 + ModuleIndex);
+		const FString ModuleName = GetSyntheticModuleName(ModuleIndex);
+		const FString ModuleDirectory = OutHeaderDump.HeaderRoot / ModuleName;
+
+		PlatformFile.CreateDirectoryTree(*(ModuleDirectory / TEXT("Public")));
+		PlatformFile.CreateDirectoryTree(*(ModuleDirectory / TEXT("Private")));
+
+		for (int32 FileIndex = 0; FileIndex < DumpParams.FilesPerModule; FileIndex++) {
+			//Headers and source files alternate, and the last file of the module is the build file which is never rewritten
+			const bool bIsBuildFile = FileIndex == DumpParams.FilesPerModule - 1;
+			const bool bIsHeaderFile = FileIndex % 2 == 0;
+			const FString ObjectName = GetSyntheticObjectName(ModuleIndex, FileIndex);
+			FString Filename;
+			
+			TArray<FString> FileLines;
+			if (bIsBuildFile) {
+				Filename = ModuleDirectory / FString::Printf(TEXT("%s.Build.cs"), *ModuleName);
+				FileLines.Add(FString::Printf(TEXT("public class %s : ModuleRules {"), *ModuleName));
+				FileLines.Add(FString::Printf(TEXT("	public %s(ReadOnlyTargetRules Target) : base(Target) {"), *ModuleName));
+				FileLines.Add(TEXT("		PublicDependencyModuleNames.AddRange(new string[] { \"Core\", \"CoreUObject\", \"Engine\" });"));
+				FileLines.Add(TEXT("	}"));
+				FileLines.Add(TEXT("}"));
+			} else {
+				Filename = ModuleDirectory / (bIsHeaderFile ? TEXT("Public") : TEXT("Private")) / ObjectName + (bIsHeaderFile ? TEXT(".h") : TEXT(".cpp"));
+				FileLines.Add(TEXT("#pragma once"));
+				FileLines.Add(TEXT("#include \"CoreMinimal.h\""));
+				
+				for (int32 LineIndex = 0; LineIndex < DumpParams.LinesPerFile; LineIndex++) {
+					if (RandomStream.GetFraction() >= DumpParams.MarkerDensity) {
+						FileLines.Add(SyntheticHeaderLines[LineIndex % UE_ARRAY_COUNT(SyntheticHeaderLines)]);
+						continue;
+					}
+
+					//Pick the kind of the object referenced by the marker according to the weights
+					const int32 MarkerKind = RandomStream.RandHelper(TotalMarkerWeight);
+					FString MarkerModuleName;
+					FString MarkerObjectName;
+					
+					if (MarkerKind < DumpParams.EngineMarkerWeight) {
+						const int32 EngineObjectIndex = RandomStream.RandHelper((int32) UE_ARRAY_COUNT(SyntheticEngineObjects));
+						MarkerModuleName = SyntheticEngineObjects[EngineObjectIndex][0];
+						MarkerObjectName = SyntheticEngineObjects[EngineObjectIndex][1];
+					} else if (MarkerKind < DumpParams.EngineMarkerWeight + DumpParams.GameMarkerWeight) {
+						const int32 OtherModuleIndex = RandomStream.RandHelper(DumpParams.NumModules);
+						MarkerModuleName = GetSyntheticModuleName(OtherModuleIndex);
+						MarkerObjectName = GetSyntheticObjectName(OtherModuleIndex, RandomStream.RandHelper(FMath::Max(DumpParams.FilesPerModule - 1, 1)));
+					} else {
+						MarkerModuleName = TEXT("Engine");
+						MarkerObjectName = FString::Printf(TEXT("BenchmarkMissingObject%d"), RandomStream.RandHelper(NumSyntheticMissingObjects));
+					}
+					FileLines.Add(FString::Printf(TEXT("//CROSS-MODULE INCLUDE V2: -ModuleName=%s -ObjectName=%s -FallbackName=%s"), *MarkerModuleName, *MarkerObjectName, *MarkerObjectName));
+					ModuleMarkers[ModuleIndex]++;
+				}
+			}
+
+			const FString FileContents = FString::Join(FileLines, TEXT("\r\n")) + TEXT("\r\n");
+			if (!FFileHelper::SaveStringToFile(FileContents, *Filename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)) {
+				UE_LOG(LogProjectGenerator, Error, TEXT("Failed to write synthetic header file %s"), *Filename);
+				bWriteFailed = true;
+				return;
+			}
+			ModuleBytes[ModuleIndex] += FTCHARToUTF8(*FileContents).Length();
+		}
+	});
+
+	if (bWriteFailed) {
+		return false;
+	}
+	for (int32 ModuleIndex = 0; ModuleIndex < DumpParams.NumModules; ModuleIndex++) {
+		OutHeaderDump.NumBytes += ModuleBytes[ModuleIndex];
+		OutHeaderDump.NumMarkers += ModuleMarkers[ModuleIndex];
+	}
+	OutHeaderDump.NumFiles = DumpParams.NumModules * DumpParams.FilesPerModule;
+
+	//Plugin manifest lists every plugin under the project plugins directory, the same way the cooked games do
+	TArray<FString> ManifestEntries;
+	for (int32 PluginIndex = 0; PluginIndex < NumPlugins; PluginIndex++) {
+		const FString PluginName = GetSyntheticPluginName(PluginIndex);
+		
+		FPluginDescriptor PluginDescriptor;
+		PluginDescriptor.FriendlyName = PluginName;
+		PluginDescriptor.Modules.Add(FModuleDescriptor(*GetSyntheticModuleName(PluginIndex)));
+
+		FString PluginDescriptorContents;
+		PluginDescriptor.Write(PluginDescriptorContents);
+		ManifestEntries.Add(FString::Printf(TEXT("{\"File\": \"../../../%s/Plugins/%s/%s.uplugin\", \"Descriptor\": %s}"), SyntheticProjectName, *PluginName, *PluginName, *PluginDescriptorContents));
+	}
+	const FString PluginManifestContents = FString::Printf(TEXT("{\"Contents\": [%s]}"), *FString::Join(ManifestEntries, TEXT(",\r\n")));
+	
+	if (!FFileHelper::SaveStringToFile(PluginManifestContents, *OutHeaderDump.PluginManifestPath)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Failed to write synthetic plugin manifest %s"), *OutHeaderDump.PluginManifestPath);
+		return false;
+	}
+
+	FProjectDescriptor ProjectDescriptor;
+	for (int32 ModuleIndex = NumPlugins; ModuleIndex < DumpParams.NumModules; ModuleIndex++) {
+		ProjectDescriptor.Modules.Add(FModuleDescriptor(*GetSyntheticModuleName(ModuleIndex)));
+	}
+	
+	FText ProjectFileErrorText;
+	if (!ProjectDescriptor.Save(OutHeaderDump.ProjectFilePath, ProjectFileErrorText)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Failed to write synthetic project file: %s"), *ProjectFileErrorText.ToString());
+		return false;
+	}
+	return true;
+}
+
+int32 FProjectGeneratorBenchmark::Run(const FString& Params, FProjectGeneratorSession& Session) {
+	FSyntheticHeaderDumpParams DumpParams;
+	FParse::Value(*Params, TEXT("ModuleCount="), DumpParams.NumModules);
+	FParse::Value(*Params, TEXT("PluginCount="), DumpParams.NumPlugins);
+	FParse::Value(*Params, TEXT("FilesPerModule="), DumpParams.FilesPerModule);
+	FParse::Value(*Params, TEXT("LinesPerFile="), DumpParams.LinesPerFile);
+	FParse::Value(*Params, TEXT("MarkerDensity="), DumpParams.MarkerDensity);
+	FParse::Value(*Params, TEXT("EngineMarkerWeight="), DumpParams.EngineMarkerWeight);
+	FParse::Value(*Params, TEXT("GameMarkerWeight="), DumpParams.GameMarkerWeight);
+	FParse::Value(*Params, TEXT("MissingMarkerWeight="), DumpParams.MissingMarkerWeight);
+	FParse::Value(*Params, TEXT("Seed="), DumpParams.Seed);
+
+	if (DumpParams.NumModules <= 0 || DumpParams.FilesPerModule <= 0 || DumpParams.LinesPerFile < 0) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Synthetic header dump needs at least one module with at least one file. Usage: %s"), Usage);
+		return 1;
+	}
+	
+	int32 NumIterations = 3;
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+	NumIterations = FMath::Max(NumIterations, 1);
+
+	FString BenchmarkDirectory = FPaths::ProjectSavedDir() / TEXT("ProjectGenerator/Benchmark");
+	FParse::Value(*Params, TEXT("BenchmarkDir="), BenchmarkDirectory);
+
+	UE_LOG(LogProjectGenerator, Display, TEXT("Synthesizing header dump with %d modules (%d in plugins), %d files per module and %d lines per file into %s"),
+		DumpParams.NumModules, FMath::Min(DumpParams.NumPlugins, DumpParams.NumModules), DumpParams.FilesPerModule, DumpParams.LinesPerFile, *BenchmarkDirectory);
+
+	FSyntheticHeaderDump HeaderDump;
+	if (!SynthesizeHeaderDump(DumpParams, BenchmarkDirectory, HeaderDump)) {
+		return 1;
+	}
+	UE_LOG(LogProjectGenerator, Display, TEXT("Synthetic header dump has %d files, %lld bytes and %d include markers"), HeaderDump.NumFiles, HeaderDump.NumBytes, HeaderDump.NumMarkers);
+
+	//Synthetic inputs come first, so they take precedence over anything else given on the command line
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString OutputDirectory = BenchmarkDirectory / TEXT("Output");
+	const FString RunParamsString = FString::Printf(TEXT("-HeaderRoot=\"%s\" -ProjectFile=\"%s\" -PluginManifest=\"%s\" -OutputDir=\"%s\" %s"),
+		*HeaderDump.HeaderRoot, *HeaderDump.ProjectFilePath, *HeaderDump.PluginManifestPath, *OutputDirectory, *Params);
+
+	TArray<double> IterationSeconds;
+	for (int32 IterationIndex = 0; IterationIndex < NumIterations; IterationIndex++) {
+		//Every iteration starts with the empty output directory, unless the incremental generation is being measured
+		if (!FParse::Param(*Params, TEXT("Incremental"))) {
+			PlatformFile.DeleteDirectoryRecursively(*OutputDirectory);
+		}
+		PlatformFile.CreateDirectoryTree(*OutputDirectory);
+
+		FCommandletRunParams RunParams;
+		if (!FProjectGenerator::ParseRunParams(RunParamsString, Usage, RunParams)) {
+			return 1;
+		}
+
+		const double IterationStartTime = FPlatformTime::Seconds();
+		if (FProjectGenerator::Generate(RunParams, Session) != 0) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Benchmark iteration %d has failed"), IterationIndex + 1);
+			return 1;
+		}
+		const double Seconds = FPlatformTime::Seconds() - IterationStartTime;
+		IterationSeconds.Add(Seconds);
+
+		UE_LOG(LogProjectGenerator, Display, TEXT("Benchmark iteration %d/%d took %.3f seconds: %.0f files/sec, %.2f MB/sec"),
+			IterationIndex + 1, NumIterations, Seconds, HeaderDump.NumFiles / Seconds, HeaderDump.NumBytes / Seconds / (1024.0 * 1024.0));
+	}
+
+	//First iteration also resolves the includes and loads the engine modules, which are cached by the session for the rest of them
+	double BestSeconds = IterationSeconds[0];
+	double TotalSeconds = 0.0;
+	for (const double Seconds : IterationSeconds) {
+		BestSeconds = FMath::Min(BestSeconds, Seconds);
+		TotalSeconds += Seconds;
+	}
+	const double MeanSeconds = TotalSeconds / IterationSeconds.Num();
+	const uint64 PeakUsedPhysical = FPlatformMemory::GetStats().PeakUsedPhysical;
+
+	UE_LOG(LogProjectGenerator, Display, TEXT("Benchmark: engine discovery %.3f seconds, best iteration %.3f seconds (%.0f files/sec, %.2f MB/sec), mean %.3f seconds, peak memory %.1f MB"),
+		Session.EngineDiscoverySeconds, BestSeconds, HeaderDump.NumFiles / BestSeconds, HeaderDump.NumBytes / BestSeconds / (1024.0 * 1024.0), MeanSeconds, PeakUsedPhysical / (1024.0 * 1024.0));
+
+	FString ReportFilePath;
+	if (FParse::Value(*Params, TEXT("BenchmarkReport="), ReportFilePath)) {
+		TArray<TSharedPtr<FJsonValue>> IterationsArray;
+		for (const double Seconds : IterationSeconds) {
+			IterationsArray.Add(MakeShareable(new FJsonValueNumber(Seconds)));
+		}
+		
+		const TSharedRef<FJsonObject> ReportObject = MakeShareable(new FJsonObject());
+		ReportObject->SetNumberField(TEXT("Modules"), DumpParams.NumModules);
+		ReportObject->SetNumberField(TEXT("Files"), HeaderDump.NumFiles);
+		ReportObject->SetNumberField(TEXT("Bytes"), HeaderDump.NumBytes);
+		ReportObject->SetNumberField(TEXT("Markers"), HeaderDump.NumMarkers);
+		ReportObject->SetNumberField(TEXT("EngineDiscoverySeconds"), Session.EngineDiscoverySeconds);
+		ReportObject->SetArrayField(TEXT("IterationSeconds"), IterationsArray);
+		ReportObject->SetNumberField(TEXT("BestFilesPerSecond"), HeaderDump.NumFiles / BestSeconds);
+		ReportObject->SetNumberField(TEXT("BestMegabytesPerSecond"), HeaderDump.NumBytes / BestSeconds / (1024.0 * 1024.0));
+		ReportObject->SetNumberField(TEXT("PeakUsedPhysicalBytes"), PeakUsedPhysical);
+
+		FString ReportContents;
+		const TSharedRef<TJsonWriter<>> ReportWriter = TJsonWriterFactory<>::Create(&ReportContents);
+		if (!FJsonSerializer::Serialize(ReportObject, ReportWriter) || !FFileHelper::SaveStringToFile(ReportContents, *ReportFilePath)) {
+			UE_LOG(LogProjectGenerator, Error, TEXT("Failed to save benchmark report to %s"), *ReportFilePath);
+			return 1;
+		}
+	}
+	return 0;
+}
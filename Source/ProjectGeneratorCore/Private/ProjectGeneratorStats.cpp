@@ -0,0 +1,127 @@
+#include "ProjectGeneratorStats.h"
+#include "ProjectGenerator.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+
+FProjectGeneratorStats::FProjectGeneratorStats() : StartTime(FPlatformTime::Seconds()) {
+}
+
+void FProjectGeneratorStats::AddPhaseTime(const FString& PhaseName, double Seconds) {
+	FScopeLock ScopeLock(&TimesLock);
+	PhaseTimes.Add(TPair<FString, double>(PhaseName, Seconds));
+}
+
+void FProjectGeneratorStats::AddModuleFileTime(FName ModuleName, double FileStartTime, double FileEndTime) {
+	FScopeLock ScopeLock(&TimesLock);
+	FModuleTime* ModuleTime = ModuleTimes.Find(ModuleName);
+	if (ModuleTime == NULL) {
+		ModuleTime = &ModuleTimes.Add(ModuleName, FModuleTime{0.0, FileStartTime, FileEndTime});
+	}
+	ModuleTime->CpuSeconds += FileEndTime - FileStartTime;
+	ModuleTime->FirstStartTime = FMath::Min(ModuleTime->FirstStartTime, FileStartTime);
+	ModuleTime->LastEndTime = FMath::Max(ModuleTime->LastEndTime, FileEndTime);
+}
+
+void FProjectGeneratorStats::LogSummary() const {
+	FScopeLock ScopeLock(&TimesLock);
+
+	for (const TPair<FString, double>& PhaseTime : PhaseTimes) {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Phase %s took %.2f seconds"), *PhaseTime.Key, PhaseTime.Value);
+	}
+	UE_LOG(LogProjectGenerator, Display, TEXT("Processed %lld files (%lld skipped, %lld linked, %lld unchanged), read %lld bytes and written %lld bytes, resolved %lld include markers"),
+		FilesProcessed.GetValue(), FilesSkipped.GetValue(), FilesLinked.GetValue(), FilesUnchanged.GetValue(), BytesRead.GetValue(), BytesWritten.GetValue(), IncludeMarkersResolved.GetValue());
+	if (bHasIncludeResolverCounters) {
+		UE_LOG(LogProjectGenerator, Display, TEXT("Force loaded %lld modules"), ModulesForceLoaded.GetValue());
+	}
+	UE_LOG(LogProjectGenerator, Display, TEXT("Peak working set is %llu MB"), (uint64) FPlatformMemory::GetStats().PeakUsedPhysical / (1024 * 1024));
+}
+
+bool FProjectGeneratorStats::SaveReport(const FString& ReportFilename) const {
+	FScopeLock ScopeLock(&TimesLock);
+
+	TArray<TSharedPtr<FJsonValue>> PhasesArray;
+	for (const TPair<FString, double>& PhaseTime : PhaseTimes) {
+		const TSharedRef<FJsonObject> PhaseObject = MakeShareable(new FJsonObject());
+		PhaseObject->SetStringField(TEXT("Name"), PhaseTime.Key);
+		PhaseObject->SetNumberField(TEXT("Seconds"), PhaseTime.Value);
+		PhasesArray.Add(MakeShareable(new FJsonValueObject(PhaseObject)));
+	}
+
+	//Modules taking the most CPU time come first, they are the most interesting ones when looking for regressions
+	TArray<TPair<FString, FModuleTime>> SortedModuleTimes;
+	for (const TPair<FName, FModuleTime>& ModuleTime : ModuleTimes) {
+		SortedModuleTimes.Add(TPair<FString, FModuleTime>(ModuleTime.Key.ToString(), ModuleTime.Value));
+	}
+	SortedModuleTimes.Sort([](const TPair<FString, FModuleTime>& A, const TPair<FString, FModuleTime>& B) {
+		return A.Value.CpuSeconds > B.Value.CpuSeconds || (A.Value.CpuSeconds == B.Value.CpuSeconds && A.Key < B.Key);
+	});
+
+	const TSharedRef<FJsonObject> ModulesObject = MakeShareable(new FJsonObject());
+	for (const TPair<FString, FModuleTime>& ModuleTime : SortedModuleTimes) {
+		const TSharedRef<FJsonObject> ModuleObject = MakeShareable(new FJsonObject());
+		ModuleObject->SetNumberField(TEXT("CpuSeconds"), ModuleTime.Value.CpuSeconds);
+		ModuleObject->SetNumberField(TEXT("WallSeconds"), ModuleTime.Value.LastEndTime - ModuleTime.Value.FirstStartTime);
+		ModulesObject->SetObjectField(ModuleTime.Key, ModuleObject);
+	}
+
+	const TSharedRef<FJsonObject> CountersObject = MakeShareable(new FJsonObject());
+	CountersObject->SetNumberField(TEXT("FilesProcessed"), FilesProcessed.GetValue());
+	CountersObject->SetNumberField(TEXT("FilesSkipped"), FilesSkipped.GetValue());
+	CountersObject->SetNumberField(TEXT("FilesLinked"), FilesLinked.GetValue());
+	CountersObject->SetNumberField(TEXT("FilesUnchanged"), FilesUnchanged.GetValue());
+	CountersObject->SetNumberField(TEXT("BytesRead"), BytesRead.GetValue());
+	CountersObject->SetNumberField(TEXT("BytesWritten"), BytesWritten.GetValue());
+	CountersObject->SetNumberField(TEXT("DirectoriesCreated"), DirectoriesCreated.GetValue());
+	CountersObject->SetNumberField(TEXT("IncludeMarkersResolved"), IncludeMarkersResolved.GetValue());
+	if (bHasIncludeResolverCounters) {
+		CountersObject->SetNumberField(TEXT("ModulesForceLoaded"), ModulesForceLoaded.GetValue());
+		CountersObject->SetNumberField(TEXT("IncludeCacheHits"), IncludeCacheHits.GetValue());
+		CountersObject->SetNumberField(TEXT("IncludeCacheMisses"), IncludeCacheMisses.GetValue());
+	}
+	CountersObject->SetNumberField(TEXT("PeakUsedPhysical"), FPlatformMemory::GetStats().PeakUsedPhysical);
+
+	const TSharedRef<FJsonObject> ReportObject = MakeShareable(new FJsonObject());
+	ReportObject->SetNumberField(TEXT("TotalSeconds"), FPlatformTime::Seconds() - StartTime);
+	ReportObject->SetArrayField(TEXT("Phases"), PhasesArray);
+	ReportObject->SetObjectField(TEXT("Modules"), ModulesObject);
+	ReportObject->SetObjectField(TEXT("Counters"), CountersObject);
+
+	FString ReportFileContents;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&ReportFileContents);
+	if (!FJsonSerializer::Serialize(ReportObject, JsonWriter)) {
+		return false;
+	}
+	return FFileHelper::SaveStringToFile(ReportFileContents, *ReportFilename);
+}
+
+FScopedGeneratorPhase::FScopedGeneratorPhase(FProjectGeneratorStats& InStats, const TCHAR* InPhaseName) : Stats(InStats), PhaseName(InPhaseName), StartTime(FPlatformTime::Seconds()) {
+#if CPUPROFILERTRACE_ENABLED
+	FCpuProfilerTrace::OutputBeginDynamicEvent(PhaseName);
+#endif
+}
+
+FScopedGeneratorPhase::~FScopedGeneratorPhase() {
+#if CPUPROFILERTRACE_ENABLED
+	FCpuProfilerTrace::OutputEndEvent();
+#endif
+	const double PhaseSeconds = FPlatformTime::Seconds() - StartTime;
+	Stats.AddPhaseTime(PhaseName, PhaseSeconds);
+	UE_LOG(LogProjectGenerator, Display, TEXT("Finished %s in %.2f seconds"), PhaseName, PhaseSeconds);
+}
+
+FScopedGeneratorTraceEvent::FScopedGeneratorTraceEvent(const TCHAR* EventName) {
+#if CPUPROFILERTRACE_ENABLED
+	FCpuProfilerTrace::OutputBeginDynamicEvent(EventName);
+#endif
+}
+
+FScopedGeneratorTraceEvent::~FScopedGeneratorTraceEvent() {
+#if CPUPROFILERTRACE_ENABLED
+	FCpuProfilerTrace::OutputEndEvent();
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+/** Timings and counters collected during the project generation. Counters can be updated from any thread */
+class FProjectGeneratorStats {
+public:
+	FProjectGeneratorStats();
+
+	FThreadSafeCounter64 FilesProcessed;
+	FThreadSafeCounter64 FilesSkipped;
+	FThreadSafeCounter64 FilesLinked;
+	FThreadSafeCounter64 FilesUnchanged;
+	FThreadSafeCounter64 BytesRead;
+	FThreadSafeCounter64 BytesWritten;
+	FThreadSafeCounter64 DirectoriesCreated;
+	FThreadSafeCounter64 IncludeMarkersResolved;
+	FThreadSafeCounter64 ModulesForceLoaded;
+	FThreadSafeCounter64 IncludeCacheHits;
+	FThreadSafeCounter64 IncludeCacheMisses;
+	/** False when the include resolver is shared with the jobs running at the same time, its counters are left out of the report then */
+	bool bHasIncludeResolverCounters = true;
+
+	/** Records the wall time of the generation phase. Phases are reported in the order they have finished */
+	void AddPhaseTime(const FString& PhaseName, double Seconds);
+
+	/**
+	 * Records processing of the single file of the module. Files of the module can be spread across multiple threads,
+	 * so both the summed CPU time of the files and the wall time from the first file starting to the last one finishing are kept
+	 */
+	void AddModuleFileTime(FName ModuleName, double FileStartTime, double FileEndTime);
+
+	/** Prints the phase timings and the counters, along with the peak working set of the process */
+	void LogSummary() const;
+	bool SaveReport(const FString& ReportFilename) const;
+private:
+	struct FModuleTime {
+		double CpuSeconds = 0.0;
+		double FirstStartTime = 0.0;
+		double LastEndTime = 0.0;
+	};
+
+	double StartTime;
+	TArray<TPair<FString, double>> PhaseTimes;
+	TMap<FName, FModuleTime> ModuleTimes;
+	mutable FCriticalSection TimesLock;
+};
+
+/** Measures wall time of the generation phase, and emits it as the CPU trace event visible in Unreal Insights */
+class FScopedGeneratorPhase {
+public:
+	FScopedGeneratorPhase(FProjectGeneratorStats& InStats, const TCHAR* InPhaseName);
+	~FScopedGeneratorPhase();
+private:
+	FProjectGeneratorStats& Stats;
+	const TCHAR* PhaseName;
+	double StartTime;
+};
+
+/** Emits the trace event with the dynamic name for the duration of the scope */
+class FScopedGeneratorTraceEvent {
+public:
+	explicit FScopedGeneratorTraceEvent(const TCHAR* EventName);
+	~FScopedGeneratorTraceEvent();
+};
@@ -0,0 +1,555 @@
+#include "SyntaxValidator.h"
+#include "GeneratedFileManifest.h"
+#include "ParallelDirectoryWalker.h"
+#include "ProjectGenerator.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+const TCHAR* FSyntaxValidator::ReportFileName = TEXT("ProjectGeneratorSyntaxReport.json");
+static const TCHAR* SyntaxCacheFileName = TEXT("SyntaxCache.json");
+static const int32 SyntaxCacheVersion = 3;
+
+//Platform directory UHT writes the engine generated headers into, and the platform name UBT passes to the compiler
+#if PLATFORM_WINDOWS
+static const TCHAR* HostBuildPlatformName = TEXT("Win64");
+static const TCHAR* HostCompiledPlatformName = TEXT("Windows");
+#elif PLATFORM_MAC
+static const TCHAR* HostBuildPlatformName = TEXT("Mac");
+static const TCHAR* HostCompiledPlatformName = TEXT("Mac");
+#else
+static const TCHAR* HostBuildPlatformName = TEXT("Linux");
+static const TCHAR* HostCompiledPlatformName = TEXT("Linux");
+#endif
+
+//Errors kept in the report for a single header, the first ones are usually the cause of the rest
+static const int32 MaxErrorsPerHeader = 20;
+
+//Splits the arguments of the macro invocation starting at the given text, returns false if the closing parenthesis has not been reached yet
+static bool ParseMacroArguments(const FString& MacroInvocation, TArray<FString>& OutArguments) {
+	const int32 ArgumentsStart = MacroInvocation.Find(TEXT("("));
+	if (ArgumentsStart == INDEX_NONE) {
+		return false;
+	}
+
+	//Commas inside of the template arguments, like in the TMap return value, do not separate the macro arguments
+	int32 ParenthesesDepth = 0;
+	int32 AngleBracketsDepth = 0;
+	FString CurrentArgument;
+
+	for (int32 CharIndex = ArgumentsStart + 1; CharIndex < MacroInvocation.Len(); CharIndex++) {
+		const TCHAR Character = MacroInvocation[CharIndex];
+		if (Character == TEXT(')') && ParenthesesDepth == 0) {
+			OutArguments.Add(CurrentArgument.TrimStartAndEnd());
+			return true;
+		}
+		if (Character == TEXT(',') && ParenthesesDepth == 0 && AngleBracketsDepth == 0) {
+			OutArguments.Add(CurrentArgument.TrimStartAndEnd());
+			CurrentArgument.Reset();
+			continue;
+		}
+		if (Character == TEXT('(')) {
+			ParenthesesDepth++;
+		} else if (Character == TEXT(')')) {
+			ParenthesesDepth--;
+		} else if (Character == TEXT('<')) {
+			AngleBracketsDepth++;
+		} else if (Character == TEXT('>')) {
+			AngleBracketsDepth = FMath::Max(AngleBracketsDepth - 1, 0);
+		}
+		CurrentArgument.AppendChar(Character);
+	}
+	return false;
+}
+
+//Turns the path of the header into the identifier unique to it, used in place of the file id UHT generates
+static FString MakeStubFileId(const FString& RelativeFilename) {
+	FString FileId = TEXT("FID_SyntaxStub_");
+	for (const TCHAR Character : FPaths::GetBaseFilename(RelativeFilename, false)) {
+		FileId.AppendChar(FChar::IsAlnum(Character) ? Character : TEXT('_'));
+	}
+	return FileId;
+}
+
+FSyntaxValidator::FSyntaxValidator(const FSyntaxValidationSettings& InSettings) : Settings(InSettings) {
+	IntermediateDirectory = FPaths::ConvertRelativePathToFull(Settings.OutputDirectory / TEXT("Intermediate") / TEXT("SyntaxValidation"));
+	ResponseFilename = IntermediateDirectory / TEXT("Compiler.rsp");
+}
+
+bool FSyntaxValidator::Prepare(const TArray<FSyntaxValidationFile>& InFiles) {
+	if (!FindCompilerExecutable(Settings.CompilerName, CompilerPath)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Failed to find the compiler %s, syntax validation is skipped"), *Settings.CompilerName);
+		return false;
+	}
+	Files = InFiles;
+	Results.SetNum(Files.Num());
+
+	//Stub generated headers of the module are placed into its own directory, the same way UBT keeps the ones UHT writes
+	const FString StubDirectory = IntermediateDirectory / TEXT("Inc");
+	TArray<FString> ModuleStubDirectories;
+	for (const FSyntaxValidationFile& File : Files) {
+		ModuleStubDirectories.AddUnique(StubDirectory / File.ModuleName);
+	}
+	ModuleStubDirectories.Sort();
+
+	TArray<FString> ModuleNames = Settings.ModuleNames;
+	ModuleNames.Sort();
+
+	//Environment matches the editor build of the engine, everything specific to the project can be passed with the additional arguments
+	TArray<FString> ResponseLines;
+	ResponseLines.Add(TEXT("-fsyntax-only"));
+	ResponseLines.Add(TEXT("-x c++"));
+	ResponseLines.Add(TEXT("-std=c++17"));
+	ResponseLines.Add(TEXT("-w"));
+	ResponseLines.Add(FString::Printf(TEXT("-DUBT_COMPILED_PLATFORM=%s"), HostCompiledPlatformName));
+	ResponseLines.Add(FString::Printf(TEXT("-DPLATFORM_%s=1"), *FString(HostCompiledPlatformName).ToUpper()));
+	ResponseLines.Add(TEXT("-DUE_BUILD_DEVELOPMENT=1"));
+	ResponseLines.Add(TEXT("-DUE_EDITOR=1"));
+	ResponseLines.Add(TEXT("-DWITH_EDITOR=1"));
+	ResponseLines.Add(TEXT("-DWITH_EDITORONLY_DATA=1"));
+	ResponseLines.Add(TEXT("-DWITH_ENGINE=1"));
+	ResponseLines.Add(TEXT("-DWITH_UNREAL_DEVELOPER_TOOLS=1"));
+	ResponseLines.Add(TEXT("-DWITH_PLUGIN_SUPPORT=1"));
+	ResponseLines.Add(TEXT("-DWITH_SERVER_CODE=1"));
+	ResponseLines.Add(TEXT("-DIS_MONOLITHIC=0"));
+	ResponseLines.Add(TEXT("-DIS_PROGRAM=0"));
+	for (const FString& ModuleName : ModuleNames) {
+		ResponseLines.Add(FString::Printf(TEXT("-D%s_API="), *ModuleName.ToUpper()));
+	}
+	for (const FString& IncludeDirectory : Settings.IncludeDirectories) {
+		ResponseLines.Add(FString::Printf(TEXT("\"-I%s\""), *IncludeDirectory));
+	}
+	for (const FString& ModuleStubDirectory : ModuleStubDirectories) {
+		ResponseLines.Add(FString::Printf(TEXT("\"-I%s\""), *ModuleStubDirectory));
+	}
+	const FString ResponseFileContents = FString::Join(ResponseLines, TEXT("\n")) + TEXT("\n");
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*IntermediateDirectory);
+	if (!FFileHelper::SaveStringToFile(ResponseFileContents, *ResponseFilename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)) {
+		UE_LOG(LogProjectGenerator, Error, TEXT("Failed to write compiler response file %s, syntax validation is skipped"), *ResponseFilename);
+		return false;
+	}
+
+	//Any change to the compiler or its arguments invalidates all of the cached results
+	TArray<FString> EnvironmentStrings;
+	EnvironmentStrings.Add(CompilerPath);
+	EnvironmentStrings.Add(Settings.CompilerArguments);
+	EnvironmentStrings.Add(ResponseFileContents);
+	EnvironmentHash = FGeneratedFileManifest::HashStrings(EnvironmentStrings);
+
+	TMap<FString, FCachedHeader> CachedHeaders;
+	LoadCache(CachedHeaders);
+
+	//Stubs are rewritten for every header that changed, the includes of the unchanged ones are taken from the cache without reading them
+	FileIncludes.SetNum(Files.Num());
+	ParallelFor(Files.Num(), [&](int32 FileIndex) {
+		const FSyntaxValidationFile& File = Files[FileIndex];
+		const FString StubFilename = StubDirectory / File.ModuleName / FPaths::GetBaseFilename(File.Filename) + TEXT(".generated.h");
+		const FCachedHeader* CachedHeader = CachedHeaders.Find(File.RelativeFilename);
+		if (CachedHeader != NULL && CachedHeader->Hash == File.ContentHash && PlatformFile.FileExists(*StubFilename)) {
+			FileIncludes[FileIndex] = CachedHeader->Includes;
+			return;
+		}
+		FString HeaderContents;
+		if (FFileHelper::LoadFileToString(HeaderContents, *File.Filename)) {
+			PlatformFile.CreateDirectoryTree(*FPaths::GetPath(StubFilename));
+			FFileHelper::SaveStringToFile(GenerateHeaderStub(MakeStubFileId(File.RelativeFilename), HeaderContents), *StubFilename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+			ParseIncludes(HeaderContents, FileIncludes[FileIndex]);
+		}
+	});
+
+	//Header can still break or get fixed when any of the generated headers it includes changes, so the result is keyed by all of them
+	ComputeDependencyHashes();
+
+	//Failures are reused along with their errors, so the headers that stay broken do not pay for the compiler on every run
+	for (int32 FileIndex = 0; FileIndex < Files.Num(); FileIndex++) {
+		const FCachedHeader* CachedHeader = CachedHeaders.Find(Files[FileIndex].RelativeFilename);
+		if (CachedHeader != NULL && CachedHeader->DependencyHash == DependencyHashes[FileIndex] && (CachedHeader->bPassed || CachedHeader->Errors.Num())) {
+			Results[FileIndex].bPassed = CachedHeader->bPassed;
+			Results[FileIndex].Errors = CachedHeader->Errors;
+		} else {
+			PendingFiles.Add(FileIndex);
+		}
+	}
+	return true;
+}
+
+void FSyntaxValidator::ParseIncludes(const FString& HeaderContents, TArray<FString>& OutIncludes) {
+	TArray<FString> HeaderLines;
+	HeaderContents.ParseIntoArrayLines(HeaderLines);
+
+	for (const FString& HeaderLine : HeaderLines) {
+		const FString TrimmedLine = HeaderLine.TrimStart();
+		if (!TrimmedLine.StartsWith(TEXT("#include"))) {
+			continue;
+		}
+		const int32 PathStart = TrimmedLine.Find(TEXT("\""));
+		const int32 PathEnd = PathStart != INDEX_NONE ? TrimmedLine.Find(TEXT("\""), ESearchCase::CaseSensitive, ESearchDir::FromStart, PathStart + 1) : INDEX_NONE;
+		if (PathEnd != INDEX_NONE) {
+			OutIncludes.Add(TrimmedLine.Mid(PathStart + 1, PathEnd - PathStart - 1));
+		}
+	}
+}
+
+void FSyntaxValidator::ComputeDependencyHashes() {
+	//Includes are resolved against the generated headers by the path suffix, the ones that do not match any are engine headers
+	TMap<FString, TArray<int32>> FilesByName;
+	for (int32 FileIndex = 0; FileIndex < Files.Num(); FileIndex++) {
+		FilesByName.FindOrAdd(FPaths::GetCleanFilename(Files[FileIndex].RelativeFilename)).Add(FileIndex);
+	}
+
+	TArray<TArray<int32>> IncludedFiles;
+	IncludedFiles.SetNum(Files.Num());
+	for (int32 FileIndex = 0; FileIndex < Files.Num(); FileIndex++) {
+		for (const FString& IncludePath : FileIncludes[FileIndex]) {
+			const TArray<int32>* CandidateFiles = FilesByName.Find(FPaths::GetCleanFilename(IncludePath));
+			if (CandidateFiles == NULL) {
+				continue;
+			}
+			//Ambiguous includes depend on all of the headers they could resolve to
+			for (const int32 CandidateFileIndex : *CandidateFiles) {
+				const FString& CandidateFilename = Files[CandidateFileIndex].RelativeFilename;
+				if (CandidateFilename == IncludePath || CandidateFilename.EndsWith(TEXT("/") + IncludePath)) {
+					IncludedFiles[FileIndex].Add(CandidateFileIndex);
+				}
+			}
+		}
+	}
+
+	//Hash covers the header itself and every generated header it includes, directly or through the other headers
+	DependencyHashes.SetNum(Files.Num());
+	ParallelFor(Files.Num(), [&](int32 FileIndex) {
+		TSet<int32> VisitedFiles;
+		TArray<int32> FilesToVisit;
+		FilesToVisit.Add(FileIndex);
+
+		while (FilesToVisit.Num()) {
+			const int32 VisitedFileIndex = FilesToVisit.Pop(false);
+			if (!VisitedFiles.Contains(VisitedFileIndex)) {
+				VisitedFiles.Add(VisitedFileIndex);
+				FilesToVisit.Append(IncludedFiles[VisitedFileIndex]);
+			}
+		}
+
+		TArray<FString> DependencyStrings;
+		for (const int32 VisitedFileIndex : VisitedFiles) {
+			DependencyStrings.Add(Files[VisitedFileIndex].RelativeFilename + TEXT(":") + Files[VisitedFileIndex].ContentHash);
+		}
+		DependencyStrings.Sort();
+		DependencyHashes[FileIndex] = FGeneratedFileManifest::HashStrings(DependencyStrings);
+	});
+}
+
+void FSyntaxValidator::CheckHeader(int32 PendingFileIndex) {
+	const int32 FileIndex = PendingFiles[PendingFileIndex];
+	const FSyntaxValidationFile& File = Files[FileIndex];
+	FHeaderResult& Result = Results[FileIndex];
+
+	const FString CompilerArguments = FString::Printf(TEXT("\"@%s\" %s \"%s\""), *ResponseFilename, *Settings.CompilerArguments, *File.Filename);
+	int32 ReturnCode = -1;
+	FString StdOut;
+	FString StdErr;
+
+	Result.bChecked = true;
+	if (!FPlatformProcess::ExecProcess(*CompilerPath, *CompilerArguments, &ReturnCode, &StdOut, &StdErr)) {
+		Result.Errors.Add(FString::Printf(TEXT("Failed to launch the compiler %s"), *CompilerPath));
+		Result.bCacheable = false;
+		return;
+	}
+	Result.bPassed = ReturnCode == 0;
+	if (Result.bPassed) {
+		return;
+	}
+
+	//Only the errors are kept, the notes and the include stacks around them are in the compiler output when the header is checked by hand
+	TArray<FString> OutputLines;
+	(StdErr + TEXT("\n") + StdOut).ParseIntoArrayLines(OutputLines);
+	for (const FString& OutputLine : OutputLines) {
+		if (OutputLine.Contains(TEXT("error:")) && Result.Errors.Num() < MaxErrorsPerHeader) {
+			Result.Errors.Add(OutputLine.TrimStartAndEnd());
+		}
+	}
+	if (Result.Errors.Num() == 0) {
+		Result.Errors.Add(FString::Printf(TEXT("Compiler has exited with the code %d"), ReturnCode));
+	}
+}
+
+int32 FSyntaxValidator::Finish() {
+	//Group the results by the module, so the report points at the modules of the dump that need attention
+	TMap<FString, TArray<int32>> ModuleFiles;
+	int32 NumCheckedFiles = 0;
+	int32 NumFailedFiles = 0;
+
+	for (int32 FileIndex = 0; FileIndex < Files.Num(); FileIndex++) {
+		ModuleFiles.FindOrAdd(Files[FileIndex].ModuleName).Add(FileIndex);
+		NumCheckedFiles += Results[FileIndex].bChecked ? 1 : 0;
+		NumFailedFiles += Results[FileIndex].bPassed ? 0 : 1;
+	}
+	ModuleFiles.KeySort(TLess<FString>());
+
+	for (const TPair<FString, TArray<int32>>& ModuleEntry : ModuleFiles) {
+		const TArray<int32>& FileIndices = ModuleEntry.Value;
+		const int32* FirstFailedFileIndex = FileIndices.FindByPredicate([&](int32 FileIndex) { return !Results[FileIndex].bPassed; });
+		if (FirstFailedFileIndex == NULL) {
+			continue;
+		}
+		const int32 NumModuleFailedFiles = FileIndices.FilterByPredicate([&](int32 FileIndex) { return !Results[FileIndex].bPassed; }).Num();
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Module %s has %d of %d headers failing the syntax validation, first error: %s"),
+			*ModuleEntry.Key, NumModuleFailedFiles, FileIndices.Num(), *Results[*FirstFailedFileIndex].Errors[0]);
+	}
+
+	if (!SaveCache()) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Failed to save syntax validation cache into %s"), *IntermediateDirectory);
+	}
+	const FString ReportFilename = Settings.OutputDirectory / ReportFileName;
+	if (!SaveReport(ReportFilename)) {
+		UE_LOG(LogProjectGenerator, Warning, TEXT("Failed to save syntax validation report to %s"), *ReportFilename);
+	}
+	UE_LOG(LogProjectGenerator, Display, TEXT("Syntax validation checked %d headers and took %d from the cache, %d of them have errors, see %s"),
+		NumCheckedFiles, Files.Num() - NumCheckedFiles, NumFailedFiles, *ReportFilename);
+	return NumFailedFiles;
+}
+
+bool FSyntaxValidator::LoadCache(TMap<FString, FCachedHeader>& OutCachedHeaders) const {
+	FString CacheFileContents;
+	if (!FFileHelper::LoadFileToString(CacheFileContents, *(IntermediateDirectory / SyntaxCacheFileName))) {
+		return false;
+	}
+	TSharedPtr<FJsonObject> CacheObject;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(CacheFileContents), CacheObject) || !CacheObject.IsValid()) {
+		return false;
+	}
+
+	//Results obtained with the different compiler or include directories are not reused
+	const TSharedPtr<FJsonObject>* FilesObject;
+	if (CacheObject->GetIntegerField(TEXT("Version")) != SyntaxCacheVersion || CacheObject->GetStringField(TEXT("Environment")) != EnvironmentHash || !CacheObject->TryGetObjectField(TEXT("Files"), FilesObject)) {
+		return false;
+	}
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& FileEntry : (*FilesObject)->Values) {
+		const TSharedPtr<FJsonObject> RecordObject = FileEntry.Value->AsObject();
+		if (!RecordObject.IsValid()) {
+			continue;
+		}
+		FCachedHeader& CachedHeader = OutCachedHeaders.Add(FileEntry.Key);
+		CachedHeader.Hash = RecordObject->GetStringField(TEXT("Hash"));
+		CachedHeader.DependencyHash = RecordObject->GetStringField(TEXT("Dependencies"));
+		CachedHeader.bPassed = RecordObject->GetBoolField(TEXT("Passed"));
+		RecordObject->TryGetStringArrayField(TEXT("Errors"), CachedHeader.Errors);
+		RecordObject->TryGetStringArrayField(TEXT("Includes"), CachedHeader.Includes);
+	}
+	return true;
+}
+
+bool FSyntaxValidator::SaveCache() const {
+	TArray<int32> SortedFileIndices;
+	for (int32 FileIndex = 0; FileIndex < Files.Num(); FileIndex++) {
+		SortedFileIndices.Add(FileIndex);
+	}
+	SortedFileIndices.Sort([&](int32 A, int32 B) { return Files[A].RelativeFilename < Files[B].RelativeFilename; });
+
+	const TSharedRef<FJsonObject> FilesObject = MakeShareable(new FJsonObject());
+	for (const int32 FileIndex : SortedFileIndices) {
+		if (!Results[FileIndex].bCacheable) {
+			continue;
+		}
+		TArray<TSharedPtr<FJsonValue>> ErrorsArray;
+		for (const FString& Error : Results[FileIndex].Errors) {
+			ErrorsArray.Add(MakeShareable(new FJsonValueString(Error)));
+		}
+		TArray<TSharedPtr<FJsonValue>> IncludesArray;
+		for (const FString& IncludePath : FileIncludes[FileIndex]) {
+			IncludesArray.Add(MakeShareable(new FJsonValueString(IncludePath)));
+		}
+
+		const TSharedRef<FJsonObject> RecordObject = MakeShareable(new FJsonObject());
+		RecordObject->SetStringField(TEXT("Hash"), Files[FileIndex].ContentHash);
+		RecordObject->SetStringField(TEXT("Dependencies"), DependencyHashes[FileIndex]);
+		RecordObject->SetBoolField(TEXT("Passed"), Results[FileIndex].bPassed);
+		RecordObject->SetArrayField(TEXT("Errors"), ErrorsArray);
+		RecordObject->SetArrayField(TEXT("Includes"), IncludesArray);
+		FilesObject->SetObjectField(Files[FileIndex].RelativeFilename, RecordObject);
+	}
+
+	const TSharedRef<FJsonObject> CacheObject = MakeShareable(new FJsonObject());
+	CacheObject->SetNumberField(TEXT("Version"), SyntaxCacheVersion);
+	CacheObject->SetStringField(TEXT("Environment"), EnvironmentHash);
+	CacheObject->SetObjectField(TEXT("Files"), FilesObject);
+
+	FString CacheFileContents;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&CacheFileContents);
+	if (!FJsonSerializer::Serialize(CacheObject, JsonWriter)) {
+		return false;
+	}
+	return FFileHelper::SaveStringToFile(CacheFileContents, *(IntermediateDirectory / SyntaxCacheFileName));
+}
+
+bool FSyntaxValidator::SaveReport(const FString& ReportFilename) const {
+	TMap<FString, TArray<int32>> ModuleFailedFiles;
+	TMap<FString, int32> ModuleNumFiles;
+	for (int32 FileIndex = 0; FileIndex < Files.Num(); FileIndex++) {
+		ModuleNumFiles.FindOrAdd(Files[FileIndex].ModuleName)++;
+		if (!Results[FileIndex].bPassed) {
+			ModuleFailedFiles.FindOrAdd(Files[FileIndex].ModuleName).Add(FileIndex);
+		}
+	}
+	ModuleFailedFiles.KeySort(TLess<FString>());
+
+	const TSharedRef<FJsonObject> ModulesObject = MakeShareable(new FJsonObject());
+	for (TPair<FString, TArray<int32>>& ModuleEntry : ModuleFailedFiles) {
+		ModuleEntry.Value.Sort([&](int32 A, int32 B) { return Files[A].RelativeFilename < Files[B].RelativeFilename; });
+
+		const TSharedRef<FJsonObject> FailedFilesObject = MakeShareable(new FJsonObject());
+		for (const int32 FileIndex : ModuleEntry.Value) {
+			TArray<TSharedPtr<FJsonValue>> ErrorsArray;
+			for (const FString& Error : Results[FileIndex].Errors) {
+				ErrorsArray.Add(MakeShareable(new FJsonValueString(Error)));
+			}
+			FailedFilesObject->SetArrayField(Files[FileIndex].RelativeFilename, ErrorsArray);
+		}
+
+		const TSharedRef<FJsonObject> ModuleObject = MakeShareable(new FJsonObject());
+		ModuleObject->SetNumberField(TEXT("Headers"), ModuleNumFiles.FindChecked(ModuleEntry.Key));
+		ModuleObject->SetNumberField(TEXT("FailedHeaders"), ModuleEntry.Value.Num());
+		ModuleObject->SetObjectField(TEXT("Errors"), FailedFilesObject);
+		ModulesObject->SetObjectField(ModuleEntry.Key, ModuleObject);
+	}
+
+	const TSharedRef<FJsonObject> ReportObject = MakeShareable(new FJsonObject());
+	ReportObject->SetStringField(TEXT("Compiler"), CompilerPath);
+	ReportObject->SetNumberField(TEXT("Headers"), Files.Num());
+	ReportObject->SetObjectField(TEXT("Modules"), ModulesObject);
+
+	FString ReportContents;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&ReportContents);
+	if (!FJsonSerializer::Serialize(ReportObject, JsonWriter)) {
+		return false;
+	}
+	return FFileHelper::SaveStringToFile(ReportContents, *ReportFilename);
+}
+
+FString FSyntaxValidator::GenerateHeaderStub(const FString& FileId, const FString& HeaderContents) {
+	TArray<FString> StubLines;
+	StubLines.Add(TEXT("//Written by the project generator syntax validation in place of the header UHT generates"));
+	StubLines.Add(TEXT("#pragma once"));
+	StubLines.Add(TEXT("#undef CURRENT_FILE_ID"));
+	StubLines.Add(FString::Printf(TEXT("#define CURRENT_FILE_ID %s"), *FileId));
+
+	//Empty lines are kept, so the line numbers match the __LINE__ the body macros are expanded with
+	TArray<FString> HeaderLines;
+	HeaderContents.ParseIntoArray(HeaderLines, TEXT("\n"), false);
+
+	for (int32 LineIndex = 0; LineIndex < HeaderLines.Num(); LineIndex++) {
+		const FString& HeaderLine = HeaderLines[LineIndex];
+		const int32 LineNumber = LineIndex + 1;
+
+		if (HeaderLine.Contains(TEXT("GENERATED_"))) {
+			StubLines.Add(FString::Printf(TEXT("#define %s_%d_GENERATED_BODY"), *FileId, LineNumber));
+			StubLines.Add(FString::Printf(TEXT("#define %s_%d_GENERATED_BODY_LEGACY"), *FileId, LineNumber));
+		}
+
+		const int32 DelegateMacroStart = HeaderLine.Find(TEXT("DECLARE_DYNAMIC_"));
+		if (DelegateMacroStart == INDEX_NONE) {
+			continue;
+		}
+		//Arguments of the delegate declaration can span multiple lines
+		FString DelegateMacro = HeaderLine.Mid(DelegateMacroStart);
+		TArray<FString> MacroArguments;
+		for (int32 NextLineIndex = LineIndex + 1; !ParseMacroArguments(DelegateMacro, MacroArguments) && NextLineIndex < HeaderLines.Num(); NextLineIndex++) {
+			MacroArguments.Reset();
+			DelegateMacro += HeaderLines[NextLineIndex];
+		}
+
+		//Broadcast and Execute of the delegate call the wrapper declared by UHT, which is declared accepting any arguments since it is never called
+		const bool bHasReturnValue = DelegateMacro.Contains(TEXT("_RetVal"));
+		if (!DelegateMacro.Contains(TEXT("_SPARSE_")) && MacroArguments.Num() >= (bHasReturnValue ? 2 : 1)) {
+			const FString ReturnType = bHasReturnValue ? MacroArguments[0] : TEXT("void");
+			const FString DelegateName = MacroArguments[bHasReturnValue ? 1 : 0];
+			StubLines.Add(FString::Printf(TEXT("#define %s_%d_DELEGATE template<typename... TArgs> static %s %s_DelegateWrapper(const TArgs&...);"), *FileId, LineNumber, *ReturnType, *DelegateName));
+		} else {
+			StubLines.Add(FString::Printf(TEXT("#define %s_%d_DELEGATE"), *FileId, LineNumber));
+		}
+	}
+	return FString::Join(StubLines, TEXT("\n")) + TEXT("\n");
+}
+
+bool FSyntaxValidator::FindCompilerExecutable(const FString& CompilerName, FString& OutCompilerPath) {
+	if (FPaths::FileExists(CompilerName)) {
+		OutCompilerPath = FPaths::ConvertRelativePathToFull(CompilerName);
+		return true;
+	}
+	//Processes are not started through the shell on every platform, so the PATH lookup is done here
+	const FString ExecutableName = FPaths::GetExtension(CompilerName).IsEmpty() && PLATFORM_WINDOWS ? CompilerName + TEXT(".exe") : CompilerName;
+	TArray<FString> SearchDirectories;
+	FPlatformMisc::GetEnvironmentVariable(TEXT("PATH")).ParseIntoArray(SearchDirectories, FPlatformMisc::GetPathVarDelimiter());
+
+	for (const FString& SearchDirectory : SearchDirectories) {
+		const FString CandidatePath = SearchDirectory / ExecutableName;
+		if (FPaths::FileExists(CandidatePath)) {
+			OutCompilerPath = CandidatePath;
+			return true;
+		}
+	}
+	return false;
+}
+
+void FSyntaxValidator::DiscoverEngineIncludeDirectories(TArray<FString>& OutIncludeDirectories) {
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	//Headers UHT has generated for the modules of the installed engine, one directory per module
+	auto AddGeneratedIncludeDirectories = [&](const FString& IntermediateDirectory, TArray<FString>& OutDirectories) {
+		const FString GeneratedIncludeRoot = IntermediateDirectory / TEXT("Build") / HostBuildPlatformName / TEXT("UE4Editor") / TEXT("Inc");
+		PlatformFile.IterateDirectory(*GeneratedIncludeRoot, [&](const TCHAR* Filename, bool bIsDirectory) {
+			if (bIsDirectory) {
+				OutDirectories.Add(Filename);
+			}
+			return true;
+		});
+	};
+
+	//Some of the engine headers are included relative to the source directory, like Runtime/Launch/Resources/Version.h
+	const FString EngineSourceDirectory = FPaths::ConvertRelativePathToFull(FPaths::EngineSourceDir());
+	OutIncludeDirectories.Add(EngineSourceDirectory);
+	AddGeneratedIncludeDirectories(FPaths::ConvertRelativePathToFull(FPaths::EngineIntermediateDir()), OutIncludeDirectories);
+
+	const FString RootDirectories[] = {EngineSourceDirectory, FPaths::ConvertRelativePathToFull(FPaths::EnginePluginsDir())};
+	for (const FString& RootDirectory : RootDirectories) {
+		WalkDirectoryTreeParallel<TArray<FString>>(RootDirectory, [&](const FString& Directory, TArray<FString>& OutSubDirectories, TArray<FString>& OutIncludeDirectoriesFound) {
+			const FString DirectoryName = FPaths::GetBaseFilename(Directory);
+			if (DirectoryName == TEXT("Saved")) {
+				return;
+			}
+			//Plugins keep the headers generated for them in their own intermediate directory
+			if (DirectoryName == TEXT("Intermediate")) {
+				AddGeneratedIncludeDirectories(Directory, OutIncludeDirectoriesFound);
+				return;
+			}
+
+			bool bIsModuleDirectory = false;
+			TArray<FString> SubDirectoryPaths;
+			PlatformFile.IterateDirectory(*Directory, [&](const TCHAR* Filename, bool bIsDirectory) {
+				if (bIsDirectory) {
+					SubDirectoryPaths.Add(Filename);
+				} else if (FString(Filename).EndsWith(TEXT(".Build.cs"))) {
+					bIsModuleDirectory = true;
+				}
+				return true;
+			});
+
+			//Only the public headers of the modules are visible to the modules depending on them
+			if (bIsModuleDirectory) {
+				for (const TCHAR* PublicDirectoryName : {TEXT("Public"), TEXT("Classes")}) {
+					const FString PublicDirectory = Directory / PublicDirectoryName;
+					if (PlatformFile.DirectoryExists(*PublicDirectory)) {
+						OutIncludeDirectoriesFound.Add(PublicDirectory);
+					}
+				}
+			} else {
+				OutSubDirectories = MoveTemp(SubDirectoryPaths);
+			}
+		}, [&](TArray<FString>& IncludeDirectoriesFound) {
+			OutIncludeDirectories.Append(IncludeDirectoriesFound);
+		});
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Generated header checked by the syntax validation */
+struct FSyntaxValidationFile {
+	FString ModuleName;
+	FString Filename;
+	/** Path of the header relative to the output directory, the cache and the report are keyed by it */
+	FString RelativeFilename;
+	/** Hash of the header contents, as recorded in the manifest of the run */
+	FString ContentHash;
+};
+
+/** Compiler and the environment the generated headers are checked in */
+struct FSyntaxValidationSettings {
+	/** Clang or GCC compatible compiler driver, either the path or the name looked up in the PATH */
+	FString CompilerName;
+	/** Additional arguments passed to the compiler after the generated ones */
+	FString CompilerArguments;
+	FString OutputDirectory;
+	/** Include directories of the generated modules followed by the ones of the engine */
+	TArray<FString> IncludeDirectories;
+	/** Modules which API macros are defined as empty */
+	TArray<FString> ModuleNames;
+};
+
+/**
+ * Runs the compiler in the syntax only mode over the generated headers, so the dump problems show up without building the whole project.
+ * UHT does not run for the generated modules, so each header gets the stub generated header defining its body macros as empty.
+ * Results are cached along with the errors by the hash of the header together with the hashes of the generated headers it includes,
+ * and the header is only checked again once any of them or the compiler environment change
+ */
+class FSyntaxValidator {
+public:
+	static const TCHAR* ReportFileName;
+
+	explicit FSyntaxValidator(const FSyntaxValidationSettings& InSettings);
+
+	/** Loads the cache of the previous run, writes the stub generated headers and the compiler response file. Returns false when the compiler cannot be found */
+	bool Prepare(const TArray<FSyntaxValidationFile>& InFiles);
+
+	int32 GetNumPendingFiles() const { return PendingFiles.Num(); }
+
+	/** Runs the compiler over the single header that needs to be checked. Thread safe for the different indices */
+	void CheckHeader(int32 PendingFileIndex);
+
+	/** Saves the cache and the report with the errors grouped by the module, returns the number of headers that have failed */
+	int32 Finish();
+
+	/** Resolves the name of the compiler into the path of its executable, looking it up in the PATH unless it is already a path */
+	static bool FindCompilerExecutable(const FString& CompilerName, FString& OutCompilerPath);
+
+	/** Collects the public include directories of the engine and engine plugin modules, along with the headers UHT has generated for them */
+	static void DiscoverEngineIncludeDirectories(TArray<FString>& OutIncludeDirectories);
+private:
+	/** Outcome of checking the single header */
+	struct FHeaderResult {
+		bool bChecked = false;
+		bool bPassed = false;
+		/** False when the compiler could not be run, such results are not written to the cache */
+		bool bCacheable = true;
+		TArray<FString> Errors;
+	};
+
+	/** Header recorded in the cache by the previous run */
+	struct FCachedHeader {
+		FString Hash;
+		/** Hash of the header and all of the generated headers it includes */
+		FString DependencyHash;
+		bool bPassed = false;
+		TArray<FString> Errors;
+		TArray<FString> Includes;
+	};
+
+	/** Loads the headers checked by the previous run, as long as the environment has not changed */
+	bool LoadCache(TMap<FString, FCachedHeader>& OutCachedHeaders) const;
+	bool SaveCache() const;
+	bool SaveReport(const FString& ReportFilename) const;
+
+	/** Generates the contents of the stub generated header, defining the body macros for each line of the header that uses one */
+	static FString GenerateHeaderStub(const FString& FileId, const FString& HeaderContents);
+
+	/** Collects the paths of the quoted includes of the header */
+	static void ParseIncludes(const FString& HeaderContents, TArray<FString>& OutIncludes);
+
+	/** Resolves the includes to the generated headers, and hashes every header together with all of the headers it includes */
+	void ComputeDependencyHashes();
+
+	FSyntaxValidationSettings Settings;
+	FString CompilerPath;
+	FString IntermediateDirectory;
+	FString ResponseFilename;
+	FString EnvironmentHash;
+	TArray<FSyntaxValidationFile> Files;
+	TArray<FHeaderResult> Results;
+	TArray<TArray<FString>> FileIncludes;
+	TArray<FString> DependencyHashes;
+	/** Indices of the files that are not cached and need to be checked */
+	TArray<int32> PendingFiles;
+};
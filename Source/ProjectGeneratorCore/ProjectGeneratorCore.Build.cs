@@ -0,0 +1,24 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class ProjectGeneratorCore : ModuleRules
+{
+	public ProjectGeneratorCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+		bLegacyPublicIncludePaths = false;
+		ShadowVariableWarningLevel = WarningLevel.Warning;
+		
+		//Must not depend on CoreUObject or Engine, the module is linked into the standalone program too
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "Projects" });
+		PrivateDependencyModuleNames.AddRange(new string[] { "Json" });
+
+		//Directory watcher is a developer module, it is only loaded at runtime by the watch mode when the target builds the developer tools
+		PrivateIncludePathModuleNames.Add("DirectoryWatcher");
+		if (Target.bBuildDeveloperTools)
+		{
+			DynamicallyLoadedModuleNames.Add("DirectoryWatcher");
+		}
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Plugins and modules discovered inside of the engine installation */
+struct FEngineDiscoverySnapshot {
+	TMap<FString, TSet<FString>> EnginePlugins;
+	TSet<FString> EngineModules;
+};
+
+/**
+ * Persists engine plugin and module discovery results between the runs
+ * Snapshot is only considered valid for the same engine installation directory, engine version,
+ * and as long as the modification times of the top level engine source and plugin directories stay the same
+ */
+class FEngineDiscoveryCache {
+public:
+	/** Returns the path of the snapshot file for the engine installation currently running */
+	static FString GetSnapshotFilePath();
+
+	/** Computes the fingerprint of the engine installation, which is much cheaper than running the discovery */
+	static FString ComputeEngineFingerprint();
+
+	static bool LoadSnapshot(const FString& SnapshotFilePath, const FString& EngineFingerprint, FEngineDiscoverySnapshot& OutSnapshot);
+	static bool SaveSnapshot(const FString& SnapshotFilePath, const FString& EngineFingerprint, const FEngineDiscoverySnapshot& Snapshot);
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Identifies a single object reference made by the CROSS-MODULE INCLUDE marker */
+struct FCrossModuleIncludeKey {
+	FString ModuleName;
+	FString ObjectName;
+	FString FallbackName;
+
+	bool operator==(const FCrossModuleIncludeKey& Other) const {
+		return ModuleName == Other.ModuleName && ObjectName == Other.ObjectName && FallbackName == Other.FallbackName;
+	}
+
+	friend uint32 GetTypeHash(const FCrossModuleIncludeKey& Key) {
+		return HashCombine(HashCombine(GetTypeHash(Key.ModuleName), GetTypeHash(Key.ObjectName)), GetTypeHash(Key.FallbackName));
+	}
+};
+
+/**
+ * Resolves objects referenced by the CROSS-MODULE INCLUDE markers into the include strings
+ * Implementations must be safe to use from the worker threads processing the header files
+ */
+class ICrossModuleIncludeResolver {
+public:
+	virtual ~ICrossModuleIncludeResolver() {}
+
+	/**
+	 * Resolves the include string for the object referenced by the header file
+	 * Returns false if the object cannot be resolved and the marker should be left untouched
+	 */
+	virtual bool ResolveInclude(const FString& HeaderFileName, const FCrossModuleIncludeKey& IncludeKey, FString& OutIncludeString) = 0;
+
+	/**
+	 * Called with all of the objects referenced by the header dump before any of the files are rewritten,
+	 * mapped to the header file referencing them, along with the set of the modules they belong to
+	 */
+	virtual void PrepareIncludes(const TMap<FCrossModuleIncludeKey, FString>& ReferencedObjects, const TSet<FString>& ReferencedModules) {}
+
+	/** Prints the amount of include lookups that have been served from the cache */
+	virtual void LogCacheStatistics() const {}
+
+	virtual int32 GetCacheHits() const { return 0; }
+	virtual int32 GetCacheMisses() const { return 0; }
+	virtual int32 GetModulesForceLoaded() const { return 0; }
+	virtual double GetModuleLoadingSeconds() const { return 0.0; }
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ICrossModuleIncludeResolver.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/ScopeRWLock.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Read-only database mapping the native objects of the script modules to their include paths, exported once from the editor
+ * Modules and the objects inside of them are sorted case insensitively, matching the way packages and objects are looked up by name,
+ * so the lookups are binary searches over the file contents, which are memory mapped rather than parsed when possible
+ * Empty include path means the object exists, but its include path could not be determined
+ */
+class PROJECTGENERATORCORE_API FIncludeDatabase {
+public:
+	FIncludeDatabase();
+	~FIncludeDatabase();
+
+	bool Load(const FString& DatabaseFilePath);
+
+	/** Returns true if the module has been known to the editor the database has been exported from */
+	bool ContainsModule(const FString& ModuleName) const;
+
+	/** Finds the include path of the object inside of the module, returns false if the module or the object are not in the database */
+	bool FindIncludePath(const FString& ModuleName, const FString& ObjectName, FString& OutIncludePath) const;
+
+	int32 GetNumModules() const;
+	FString GetEngineVersion() const;
+
+	/** Writes the database, module name to the object name to the include path of the object */
+	static bool Save(const FString& DatabaseFilePath, const FString& EngineVersion, const TMap<FString, TMap<FString, FString>>& ModuleObjectIncludePaths);
+private:
+	struct FHeader;
+	struct FModuleEntry;
+	struct FObjectEntry;
+
+	bool InitializeFromData(const uint8* Data, int64 DataSize, const FString& DatabaseFilePath);
+	const FModuleEntry* FindModule(const ANSICHAR* ModuleName) const;
+	const ANSICHAR* GetString(uint32 StringOffset) const;
+
+	TUniquePtr<IMappedFileHandle> MappedFileHandle;
+	TUniquePtr<IMappedFileRegion> MappedFileRegion;
+	/** Used instead of the mapped region when the platform does not support memory mapped files */
+	TArray<uint8> LoadedFileContents;
+
+	const FHeader* Header;
+	const FModuleEntry* Modules;
+	const FObjectEntry* Objects;
+	const ANSICHAR* StringTable;
+};
+
+/**
+ * Resolves cross module includes by looking them up in the include database, without any engine modules being loaded
+ * Results are memoized per referenced object, including the ones that could not be resolved, so each of them is only warned about once
+ */
+class PROJECTGENERATORCORE_API FIncludeDatabaseResolver : public ICrossModuleIncludeResolver {
+public:
+	bool Load(const FString& DatabaseFilePath);
+
+	virtual bool ResolveInclude(const FString& HeaderFileName, const FCrossModuleIncludeKey& IncludeKey, FString& OutIncludeString) override;
+	virtual void LogCacheStatistics() const override;
+	virtual int32 GetCacheHits() const override { return CacheHits.GetValue(); }
+	virtual int32 GetCacheMisses() const override { return CacheMisses.GetValue(); }
+private:
+	bool LookupInclude(const FCrossModuleIncludeKey& IncludeKey, FString& OutIncludeString) const;
+
+	FIncludeDatabase IncludeDatabase;
+
+	/** Resolved include strings, empty string means the object could not be resolved */
+	TMap<FCrossModuleIncludeKey, FString> ResolvedIncludeCache;
+	mutable FRWLock ResolvedIncludeCacheLock;
+	FThreadSafeCounter CacheHits;
+	FThreadSafeCounter CacheMisses;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "PluginManifest.h"
+#include "ProjectDescriptor.h"
+
+PROJECTGENERATORCORE_API DECLARE_LOG_CATEGORY_EXTERN(LogProjectGenerator, All, All);
+
+struct FEngineDiscoverySnapshot;
+struct FProjectGeneratorSession;
+
+/** How the files carried over without any changes are placed into the output directory */
+enum class EGeneratedFileLinkMode : uint8 {
+	Copy,
+	HardLink,
+	Reflink
+};
+
+/** Results of the last full generation the watch mode keeps between the regenerations, so only the modules with the changed files are processed again */
+struct FProjectGeneratorWatchState {
+	bool bIsValid = false;
+	/** Module directories of the header dump, adding or removing any of them needs the full generation again */
+	TSet<FString> HeaderDumpModules;
+	/** Modules selected with -Modules along with the modules they reference */
+	TSet<FString> SelectedModules;
+	/** Objects moved into the split headers of each module, along with the include paths of the split headers */
+	TMap<FString, TArray<TPair<FString, FString>>> ModuleSplitObjectIncludePaths;
+};
+
+struct FCommandletRunParams {
+	FString Params;
+	FString ProjectName;
+	FPluginManifest PluginManifest;
+	FProjectDescriptor ProjectFile;
+	FString GeneratedHeaderDir;
+	FString OutputDirectory;
+	int32 NumThreads = 1;
+	int32 NumIOThreads = 0;
+	int32 MemoryLimitMB = 0;
+	bool bIncremental = false;
+	FString StatsFilePath;
+	bool bDryRun = false;
+	FString PlanFilePath;
+	EGeneratedFileLinkMode LinkMode = EGeneratedFileLinkMode::Copy;
+	bool bGeneratePCH = false;
+	bool bPruneBuildDependencies = false;
+	FString DependencyGraphPath;
+	bool bForwardDeclare = false;
+	bool bSplitHeaders = false;
+	/** When set, the generated headers are checked with the compiler after the generation, see FSyntaxValidator */
+	bool bValidateSyntax = false;
+	FString SyntaxCompiler = TEXT("clang++");
+	FString SyntaxCompilerArguments;
+	/** Modules requested with -Modules, only they and the modules they include are generated when it is not empty */
+	TArray<FString> SelectedModules;
+	/** When set, only the module files from the changed file set are processed, and the rest are carried over from the previous run manifest */
+	bool bOnlyChangedFiles = false;
+	TSet<FString> ChangedSourceFiles;
+	/** Modules owning the changed files. Directories of the other modules are not walked when the watch state is valid, and their files are carried over as they are */
+	TSet<FString> ChangedModules;
+	/** Kept by the watch mode between the regenerations, filled by the full generation */
+	FProjectGeneratorWatchState* WatchState = NULL;
+};
+
+/**
+ * Generates the project from the header dump, project file and plugin manifest
+ * Only depends on the Core, Projects and Json modules, so it can be used both by the editor commandlet and by the standalone program.
+ * DirectoryWatcher used by the watch mode is loaded dynamically, and the watch mode fails when the build does not include it.
+ * Everything that needs the live UObject registry is hidden behind the include resolver provided by the session
+ */
+class PROJECTGENERATORCORE_API FProjectGenerator {
+public:
+	/** Parses the arguments of the single generation job, usage string is printed when required arguments are missing */
+	static bool ParseRunParams(const FString& Params, const FString& Usage, FCommandletRunParams& ResultParams);
+
+	/** Parses the batch file into the list of jobs, each non-empty line not starting with # being the arguments of a single job */
+	static bool ParseBatchFile(const FString& Params, const FString& BatchFilePath, const FString& Usage, TArray<FCommandletRunParams>& BatchJobs);
+
+	/** Discovers the engine plugins and modules. Include resolver of the session is left for the caller to create */
+	static void InitializeSession(bool bRefreshEngineCache, FProjectGeneratorSession& OutSession);
+
+	/** Discovers the engine modules inside of the given directory of the engine source, like Runtime or Editor */
+	static void DiscoverEngineSourceModules(const FString& SourceSubdirectory, TSet<FString>& OutModulesFound);
+
+	/** Generates the single project, returns the process exit code */
+	static int32 Generate(FCommandletRunParams& Params, FProjectGeneratorSession& Session);
+
+	/**
+	 * Generates the project, then keeps watching the header dump, project file and plugin manifest for changes and regenerates the project on every change.
+	 * Returns when the engine exit is requested, or if the first generation has failed
+	 */
+	static int32 Watch(FCommandletRunParams& Params, const FString& Usage, FProjectGeneratorSession& Session);
+
+	/** Generates all of the jobs in the batch, running up to the given number of them at the same time */
+	static int32 RunBatch(TArray<FCommandletRunParams>& BatchJobs, int32 BatchConcurrency, FProjectGeneratorSession& Session);
+private:
+	static bool GenerateTargetFile(FCommandletRunParams& Params, const FString& TargetFileName, const TSet<FString>& GameModuleNames);
+	static bool SaveGeneratedFile(const FString& FileContents, const FString& Filename);
+	static void DiscoverEngineContents(bool bRefreshEngineCache, FEngineDiscoverySnapshot& OutSnapshot);
+	static void DiscoverPlugins(const FString& PluginDirectory, TMap<FString, TSet<FString>>& OutPluginsFound);
+	static void DiscoverModules(const FString& SourceDirectory, TSet<FString>& OutModulesFound);
+};
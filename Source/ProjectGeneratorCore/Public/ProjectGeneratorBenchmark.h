@@ -0,0 +1,44 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FProjectGeneratorSession;
+
+/** Shape of the synthetic header dump generated for the benchmark */
+struct FSyntheticHeaderDumpParams {
+	int32 NumModules = 50;
+	int32 NumPlugins = 5;
+	int32 FilesPerModule = 40;
+	int32 LinesPerFile = 200;
+	/** Fraction of the lines that are the cross module include markers */
+	float MarkerDensity = 0.02f;
+	/** Relative weights of the markers referencing engine objects, objects of the other synthetic modules and objects that do not exist */
+	int32 EngineMarkerWeight = 60;
+	int32 GameMarkerWeight = 30;
+	int32 MissingMarkerWeight = 10;
+	int32 Seed = 0;
+};
+
+/** Size of the synthetic header dump, used to compute the throughput */
+struct FSyntheticHeaderDump {
+	FString HeaderRoot;
+	FString ProjectFilePath;
+	FString PluginManifestPath;
+	int32 NumFiles = 0;
+	int64 NumBytes = 0;
+	int32 NumMarkers = 0;
+};
+
+/**
+ * Measures the generator on the synthetic header dump of the configurable size, so the performance can be compared between changes
+ * without sharing the real game dumps. Runs the normal generation the given number of times and reports files/sec, MB/sec and peak memory
+ */
+class PROJECTGENERATORCORE_API FProjectGeneratorBenchmark {
+public:
+	static const TCHAR* Usage;
+
+	/** Runs the benchmark with the given arguments, arguments of the normal generation (like -Threads) are forwarded to every iteration */
+	static int32 Run(const FString& Params, FProjectGeneratorSession& Session);
+
+	/** Writes the header dump, plugin manifest and project file for the given parameters into the directory. Output only depends on the parameters */
+	static bool SynthesizeHeaderDump(const FSyntheticHeaderDumpParams& DumpParams, const FString& BenchmarkDirectory, FSyntheticHeaderDump& OutHeaderDump);
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ICrossModuleIncludeResolver.h"
+#include "EngineDiscoveryCache.h"
+
+/**
+ * State shared between all of the projects generated during the single commandlet run
+ * Engine is only discovered once per session, and the include resolver keeps both the engine modules it has force loaded
+ * and the includes it has resolved, so the jobs running later in the batch do not repeat the same work
+ */
+struct FProjectGeneratorSession {
+	FEngineDiscoverySnapshot EngineSnapshot;
+	double EngineDiscoverySeconds = 0.0;
+	TUniquePtr<ICrossModuleIncludeResolver> IncludeResolver;
+	/** Set while the batch jobs run at the same time, so the work done by the include resolver cannot be attributed to any single one of them */
+	bool bRunningConcurrentJobs = false;
+	/** Include directories of the engine used by the syntax validation, only discovered by the first job that needs them */
+	TArray<FString> EngineIncludeDirectories;
+};